@@ -209,6 +209,39 @@ inline char32_t validate_utf32_char(char32_t character)
     return UNI_REPLACEMENT_CHAR;
 }
 
+/**
+*   \brief  Retrieves the value of a single code unit, without sign extension.
+*
+*   \remarks
+*       Every ASCII character is stored as a single code unit below 0x80 in UTF-8, UTF-16 and
+*       UTF-32, so code that only cares about ASCII can look at units directly instead of
+*       decoding each character with nextchar().
+*/
+template <typename T>
+inline char32_t _codeunit(T unit)
+{
+    return (char32_t)unit;
+}
+
+inline char32_t _codeunit(char unit)
+{
+    return (char32_t)(unsigned char)unit;
+}
+
+/**
+*   \brief  Names T in a parameter without letting the compiler deduce it from that parameter.
+*
+*   \remarks
+*       This lets a function over a const string take a literal delimiter, such as
+*       split(text.start, ",", ...), where T would otherwise be deduced as both const char and char.
+*/
+template <typename T>
+struct _nondeduced
+{
+    typedef T type;
+};
+
+
 template <typename T>
 void _movestr(T *dest, T *source, size_t count)
 {
@@ -0,0 +1,1364 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+//
+// SIMD helpers. SSE2 is used when the compiler says it's available, which is always the case for
+// 64-bit x86. Define DRSL_NO_SIMD before including drsl.h to force the scalar versions. Every
+// function here has a scalar fallback which produces exactly the same results.
+
+#ifndef DRSL_SIMD
+#define DRSL_SIMD
+
+#if !defined(DRSL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define DRSL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Null terminated strings are scanned with aligned loads which can read past the terminator. That
+// can't fault, but address sanitizers report it, so it's turned off when one is in use.
+#if defined(__SANITIZE_ADDRESS__)
+#define DRSL_SIMD_NO_OVERREAD
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define DRSL_SIMD_NO_OVERREAD
+#endif
+#endif
+
+namespace drsl
+{
+
+/**
+*   \brief  Retrieves the number of trailing zero bits in a non-zero 32-bit value.
+*/
+inline unsigned int _ctz32(uint32_t value)
+{
+    assert(value != 0);
+
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctz(value);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (unsigned int)index;
+#else
+    unsigned int count = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        ++count;
+    }
+
+    return count;
+#endif
+}
+
+/**
+*   \brief  Retrieves the number of bits set in a 32-bit value.
+*/
+inline unsigned int _popcount32(uint32_t value)
+{
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_popcount(value);
+#else
+    value = value - ((value >> 1) & 0x55555555);
+    value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+    return (unsigned int)((((value + (value >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
+}
+
+/**
+*   \brief  Retrieves the number of trailing zero bits in a non-zero 64-bit value.
+*/
+inline unsigned int _ctz64(uint64_t value)
+{
+    assert(value != 0);
+
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctzll(value);
+#else
+    uint32_t low = (uint32_t)value;
+    return (low != 0) ? _ctz32(low) : 32 + _ctz32((uint32_t)(value >> 32));
+#endif
+}
+
+/**
+*   \brief  Retrieves the number of bits set in a 64-bit value.
+*/
+inline unsigned int _popcount64(uint64_t value)
+{
+    return _popcount32((uint32_t)value) + _popcount32((uint32_t)(value >> 32));
+}
+
+
+/**
+*   \brief             Finds the first code unit in [str, end) that is equal to either \c a or \c b.
+*   \param  str  [in]  The start of the range to search.
+*   \param  end  [in]  The end of the range to search.
+*   \param  a    [in]  The first code unit to look for.
+*   \param  b    [in]  The second code unit to look for.
+*   \return            A pointer to the first matching code unit, or \c end if there isn't one.
+*
+*   \remarks
+*       The 8- and 16-bit versions compare 16 or 8 code units at a time. Nothing outside of
+*       [str, end) is ever read.
+*/
+template <typename T>
+inline const T * _findeither(const T *str, const T *end, T a, T b)
+{
+    while (str < end && *str != a && *str != b)
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char * _findeither(const char *str, const char *end, char a, char b)
+{
+#ifdef DRSL_SIMD_SSE2
+    __m128i a_16 = _mm_set1_epi8(a);
+    __m128i b_16 = _mm_set1_epi8(b);
+
+    while (end - str >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, a_16), _mm_cmpeq_epi8(chunk, b_16)));
+        if (mask != 0)
+        {
+            return str + _ctz32((uint32_t)mask);
+        }
+
+        str += 16;
+    }
+#endif
+
+    while (str < end && *str != a && *str != b)
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char16_t * _findeither(const char16_t *str, const char16_t *end, char16_t a, char16_t b)
+{
+#ifdef DRSL_SIMD_SSE2
+    __m128i a_8 = _mm_set1_epi16((short)a);
+    __m128i b_8 = _mm_set1_epi16((short)b);
+
+    while (end - str >= 8)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(chunk, a_8), _mm_cmpeq_epi16(chunk, b_8)));
+        if (mask != 0)
+        {
+            // Each matching unit sets two bits in the mask.
+            return str + (_ctz32((uint32_t)mask) >> 1);
+        }
+
+        str += 8;
+    }
+#endif
+
+    while (str < end && *str != a && *str != b)
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+
+// The scalar classification used by the run skipping functions below. White space here is the
+// same as in nexttoken() - anything in (0, ' '] - except that new lines are not included, because
+// the tokenizers need to see each of them.
+inline bool _isblankunit(char32_t unit)
+{
+    return unit > 0 && unit <= ' ' && unit != '\n';
+}
+
+inline bool _isidentifierunit(char32_t unit)
+{
+    return (unit >= 'a' && unit <= 'z') || (unit >= 'A' && unit <= 'Z') || (unit >= '0' && unit <= '9') || unit == '_';
+}
+
+#ifdef DRSL_SIMD_SSE2
+// Bit i is set for each byte i in 'chunk' that is a blank.
+inline uint32_t _blankmask8(__m128i chunk)
+{
+    // The comparisons are signed, so bytes above 127 are negative and never match.
+    __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_setzero_si128()), _mm_cmplt_epi8(chunk, _mm_set1_epi8(' ' + 1)));
+    __m128i newline  = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+    return (uint32_t)_mm_movemask_epi8(_mm_andnot_si128(newline, in_range));
+}
+
+// Bit i is set for each byte i in 'chunk' that is an ASCII letter, digit or underscore.
+inline uint32_t _identifiermask8(__m128i chunk)
+{
+    // An unsigned "x - low < count" range check is done as a signed comparison by offsetting both
+    // sides by 0x80. Setting bit 5 folds upper case letters onto lower case.
+    __m128i lower  = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_cmplt_epi8(_mm_sub_epi8(lower, _mm_set1_epi8((char)(0x80 + 'a'))), _mm_set1_epi8((char)(0x80 + 26)));
+    __m128i digit  = _mm_cmplt_epi8(_mm_sub_epi8(chunk, _mm_set1_epi8((char)(0x80 + '0'))), _mm_set1_epi8((char)(0x80 + 10)));
+    __m128i under  = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_'));
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), under));
+}
+
+// The 16-bit versions. Each unit sets two bits in the mask.
+inline uint32_t _blankmask16(__m128i chunk)
+{
+    __m128i in_range = _mm_and_si128(_mm_cmpgt_epi16(chunk, _mm_setzero_si128()), _mm_cmplt_epi16(chunk, _mm_set1_epi16(' ' + 1)));
+    __m128i newline  = _mm_cmpeq_epi16(chunk, _mm_set1_epi16('\n'));
+    return (uint32_t)_mm_movemask_epi8(_mm_andnot_si128(newline, in_range));
+}
+
+inline uint32_t _identifiermask16(__m128i chunk)
+{
+    __m128i lower  = _mm_or_si128(chunk, _mm_set1_epi16(0x20));
+    __m128i letter = _mm_cmplt_epi16(_mm_sub_epi16(lower, _mm_set1_epi16((short)(0x8000 + 'a'))), _mm_set1_epi16((short)(0x8000 + 26)));
+    __m128i digit  = _mm_cmplt_epi16(_mm_sub_epi16(chunk, _mm_set1_epi16((short)(0x8000 + '0'))), _mm_set1_epi16((short)(0x8000 + 10)));
+    __m128i under  = _mm_cmpeq_epi16(chunk, _mm_set1_epi16('_'));
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), under));
+}
+
+// Skips the code units at the start of [str, end) for which 'runmask' sets the bits, 16 bytes at a
+// time. 'unitSize' is the size of a code unit in bytes. Returns the first code unit that is not
+// part of the run, or the position where fewer than 16 bytes are left for the scalar loop to
+// finish off.
+//
+// When 'end' is NULL the string is null terminated. The null terminator is never part of a run, so
+// aligned loads are used which stop in the 16 byte block holding the terminator. An aligned load
+// never crosses a page boundary, so the bytes it reads past the terminator (or before 'str') can't
+// fault, which is the same thing optimized strlen() implementations do.
+template <typename T, typename MaskFunction>
+inline const T * _skiprun(const T *str, const T *end, MaskFunction runmask, bool &done)
+{
+    done = false;
+
+    if (end == NULL)
+    {
+#ifdef DRSL_SIMD_NO_OVERREAD
+        return str;
+#endif
+
+        if (((uintptr_t)str % sizeof(T)) != 0)
+        {
+            return str;
+        }
+
+        const char *block = (const char *)((uintptr_t)str & ~(uintptr_t)15);
+        uint32_t stop = ~runmask(_mm_load_si128((const __m128i *)block)) & 0xFFFF;
+        stop &= 0xFFFFU << ((const char *)str - block);
+
+        while (stop == 0)
+        {
+            block += 16;
+            stop = ~runmask(_mm_load_si128((const __m128i *)block)) & 0xFFFF;
+        }
+
+        done = true;
+        return (const T *)(block + _ctz32(stop));
+    }
+
+    while ((size_t)(end - str) * sizeof(T) >= 16)
+    {
+        uint32_t stop = ~runmask(_mm_loadu_si128((const __m128i *)str)) & 0xFFFF;
+        if (stop != 0)
+        {
+            done = true;
+            return (const T *)((const char *)str + _ctz32(stop));
+        }
+
+        str += 16 / sizeof(T);
+    }
+
+    return str;
+}
+#endif
+
+
+/**
+*   \brief             Skips a run of blank code units, which is white space other than new lines.
+*   \param  str  [in]  The start of the run.
+*   \param  end  [in]  The end of the string, or NULL if the string is null terminated.
+*   \return            A pointer to the first code unit that is not a blank.
+*
+*   \remarks
+*       The 8- and 16-bit versions classify 16 bytes at a time. Code units outside of ASCII are
+*       never blanks, so the caller can decode those one character at a time as usual.
+*/
+template <typename T>
+inline const T * _skipblanks(const T *str, const T *end)
+{
+    while (str != end && _isblankunit(_codeunit(*str)))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char * _skipblanks(const char *str, const char *end)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, end, _blankmask8, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (str != end && _isblankunit(_codeunit(*str)))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char16_t * _skipblanks(const char16_t *str, const char16_t *end)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, end, _blankmask16, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (str != end && _isblankunit(_codeunit(*str)))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+
+/**
+*   \brief             Skips a run of ASCII letters, digits and underscores.
+*   \param  str  [in]  The start of the run.
+*   \param  end  [in]  The end of the string, or NULL if the string is null terminated.
+*   \return            A pointer to the first code unit that is not part of the run.
+*
+*   \remarks
+*       These are the characters that continue a word or number token. See _skipblanks().
+*/
+template <typename T>
+inline const T * _skipidentifier(const T *str, const T *end)
+{
+    while (str != end && _isidentifierunit(_codeunit(*str)))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char * _skipidentifier(const char *str, const char *end)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, end, _identifiermask8, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (str != end && _isidentifierunit(_codeunit(*str)))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char16_t * _skipidentifier(const char16_t *str, const char16_t *end)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, end, _identifiermask16, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (str != end && _isidentifierunit(_codeunit(*str)))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+
+
+#ifdef DRSL_SIMD_SSE2
+// Works out the stop and new line masks for _skiptounit(). Bit i of 'stop' is set for each byte i
+// of 'chunk' that is part of the unit being looked for, a null terminator or a unit outside of
+// ASCII. 'lines' is the same for new lines.
+struct _stopmask8
+{
+    explicit _stopmask8(char unit)
+        : unit(_mm_set1_epi8(unit)), newLine(_mm_set1_epi8('\n'))
+    {
+    }
+
+    void operator()(__m128i chunk, uint32_t &stop, uint32_t &lines) const
+    {
+        // Bytes above 127 have their top bit set, so the chunk itself marks them for movemask.
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(chunk, this->unit), _mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+        stop  = (uint32_t)_mm_movemask_epi8(_mm_or_si128(hit, chunk));
+        lines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, this->newLine));
+    }
+
+    __m128i unit;
+    __m128i newLine;
+};
+
+struct _stopmask16
+{
+    explicit _stopmask16(char16_t unit)
+        : unit(_mm_set1_epi16((short)unit)), newLine(_mm_set1_epi16('\n'))
+    {
+    }
+
+    void operator()(__m128i chunk, uint32_t &stop, uint32_t &lines) const
+    {
+        __m128i zero  = _mm_setzero_si128();
+        __m128i other = _mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16((short)0xFF80)), zero);
+        __m128i hit   = _mm_or_si128(_mm_cmpeq_epi16(chunk, this->unit), _mm_cmpeq_epi16(chunk, zero));
+        stop  = (uint32_t)_mm_movemask_epi8(_mm_or_si128(hit, _mm_andnot_si128(other, _mm_set1_epi16(-1))));
+        lines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(chunk, this->newLine));
+    }
+
+    __m128i unit;
+    __m128i newLine;
+};
+
+// The SIMD part of _skiptounit(). This reads 16 bytes at a time the same way as _skiprun(),
+// including the aligned loads for null terminated strings. New lines are counted up to the stop.
+template <typename T, typename StopMask>
+inline const T * _skiptostop(const T *str, const T *end, const StopMask &stopmask, size_t &newLines, bool &done)
+{
+    done = false;
+
+    uint32_t stop;
+    uint32_t lines;
+    size_t line_bits = 0;
+
+    if (end == NULL)
+    {
+#ifdef DRSL_SIMD_NO_OVERREAD
+        return str;
+#endif
+
+        if (((uintptr_t)str % sizeof(T)) != 0)
+        {
+            return str;
+        }
+
+        const char *block = (const char *)((uintptr_t)str & ~(uintptr_t)15);
+        stopmask(_mm_load_si128((const __m128i *)block), stop, lines);
+
+        uint32_t valid = 0xFFFFU << ((const char *)str - block);
+        stop  &= valid;
+        lines &= valid;
+
+        while (stop == 0)
+        {
+            line_bits += _popcount32(lines);
+
+            block += 16;
+            stopmask(_mm_load_si128((const __m128i *)block), stop, lines);
+        }
+
+        unsigned int position = _ctz32(stop);
+        line_bits += _popcount32(lines & ((1U << position) - 1));
+
+        // Each 16-bit unit sets two bits.
+        newLines += line_bits / sizeof(T);
+        done = true;
+        return (const T *)(block + position);
+    }
+
+    while ((size_t)(end - str) * sizeof(T) >= 16)
+    {
+        stopmask(_mm_loadu_si128((const __m128i *)str), stop, lines);
+        if (stop != 0)
+        {
+            unsigned int position = _ctz32(stop);
+            line_bits += _popcount32(lines & ((1U << position) - 1));
+
+            newLines += line_bits / sizeof(T);
+            done = true;
+            return (const T *)((const char *)str + position);
+        }
+
+        line_bits += _popcount32(lines);
+        str += 16 / sizeof(T);
+    }
+
+    newLines += line_bits / sizeof(T);
+    return str;
+}
+#endif
+
+
+/**
+*   \brief                  Skips code units up to the next occurrence of a particular ASCII code unit, counting new lines along the way.
+*   \param  str      [in]   The start of the range to skip.
+*   \param  end      [in]   The end of the string, or NULL if the string is null terminated.
+*   \param  unit     [in]   The code unit to stop at. This must be in ASCII.
+*   \param  newLines [out]  The number of new lines skipped over is added to this.
+*   \return                 A pointer to the first code unit that is \c unit, a null terminator or outside of ASCII, or \c end.
+*
+*   \remarks
+*       This is used to jump through ignore blocks to the next place an ending string could
+*       start. The unit that is stopped at is not counted, even if it's a new line. Code units
+*       outside of ASCII are stopped at so the caller can decode them.
+*/
+template <typename T>
+inline const T * _skiptounit(const T *str, const T *end, T unit, size_t &newLines)
+{
+    for ( ; str != end; ++str)
+    {
+        char32_t value = _codeunit(*str);
+        if (value == _codeunit(unit) || value == '\0' || value >= 128)
+        {
+            break;
+        }
+
+        if (value == '\n')
+        {
+            newLines += 1;
+        }
+    }
+
+    return str;
+}
+
+inline const char * _skiptounit(const char *str, const char *end, char unit, size_t &newLines)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiptostop(str, end, _stopmask8(unit), newLines, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    for ( ; str != end; ++str)
+    {
+        char32_t value = _codeunit(*str);
+        if (value == (char32_t)unit || value == '\0' || value >= 128)
+        {
+            break;
+        }
+
+        if (value == '\n')
+        {
+            newLines += 1;
+        }
+    }
+
+    return str;
+}
+
+inline const char16_t * _skiptounit(const char16_t *str, const char16_t *end, char16_t unit, size_t &newLines)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiptostop(str, end, _stopmask16(unit), newLines, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    for ( ; str != end; ++str)
+    {
+        char32_t value = _codeunit(*str);
+        if (value == (char32_t)unit || value == '\0' || value >= 128)
+        {
+            break;
+        }
+
+        if (value == '\n')
+        {
+            newLines += 1;
+        }
+    }
+
+    return str;
+}
+
+
+
+/**
+*   \brief                   Finds the first code unit in [str, end) that is equal to any of a small set of code units.
+*   \param  str       [in]   The start of the range to search.
+*   \param  end       [in]   The end of the range to search.
+*   \param  units     [in]   The code units to look for.
+*   \param  unitCount [in]   The number of code units in \c units. This must be between 1 and 8.
+*   \return                  A pointer to the first matching code unit, or \c end if there isn't one.
+*
+*   \remarks
+*       The 8- and 16-bit versions compare 16 bytes against each unit at a time. SSE2 has no byte
+*       shuffle to classify against a lookup table, so the set is kept small instead. Nothing
+*       outside of [str, end) is ever read.
+*/
+template <typename T>
+inline const T * _findanyof(const T *str, const T *end, const T *units, size_t unitCount)
+{
+    assert(unitCount > 0 && unitCount <= 8);
+
+    for ( ; str < end; ++str)
+    {
+        for (size_t i = 0; i < unitCount; ++i)
+        {
+            if (*str == units[i])
+            {
+                return str;
+            }
+        }
+    }
+
+    return str;
+}
+
+inline const char * _findanyof(const char *str, const char *end, const char *units, size_t unitCount)
+{
+    assert(unitCount > 0 && unitCount <= 8);
+
+#ifdef DRSL_SIMD_SSE2
+    __m128i sets[8];
+    for (size_t i = 0; i < unitCount; ++i)
+    {
+        sets[i] = _mm_set1_epi8(units[i]);
+    }
+
+    while (end - str >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+        __m128i hit = _mm_cmpeq_epi8(chunk, sets[0]);
+        for (size_t i = 1; i < unitCount; ++i)
+        {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, sets[i]));
+        }
+
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            return str + _ctz32((uint32_t)mask);
+        }
+
+        str += 16;
+    }
+#endif
+
+    for ( ; str < end; ++str)
+    {
+        for (size_t i = 0; i < unitCount; ++i)
+        {
+            if (*str == units[i])
+            {
+                return str;
+            }
+        }
+    }
+
+    return str;
+}
+
+inline const char16_t * _findanyof(const char16_t *str, const char16_t *end, const char16_t *units, size_t unitCount)
+{
+    assert(unitCount > 0 && unitCount <= 8);
+
+#ifdef DRSL_SIMD_SSE2
+    __m128i sets[8];
+    for (size_t i = 0; i < unitCount; ++i)
+    {
+        sets[i] = _mm_set1_epi16((short)units[i]);
+    }
+
+    while (end - str >= 8)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+        __m128i hit = _mm_cmpeq_epi16(chunk, sets[0]);
+        for (size_t i = 1; i < unitCount; ++i)
+        {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi16(chunk, sets[i]));
+        }
+
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            // Each matching unit sets two bits in the mask.
+            return str + (_ctz32((uint32_t)mask) >> 1);
+        }
+
+        str += 8;
+    }
+#endif
+
+    for ( ; str < end; ++str)
+    {
+        for (size_t i = 0; i < unitCount; ++i)
+        {
+            if (*str == units[i])
+            {
+                return str;
+            }
+        }
+    }
+
+    return str;
+}
+
+
+
+/**
+*   \brief              Moves forward over a number of characters.
+*   \param  str   [in]  The start of a character.
+*   \param  end   [in]  The end of the string.
+*   \param  count [in]  The number of characters to move over.
+*   \return             A pointer to the start of the character after them, or \c end if the string runs out first.
+*
+*   \remarks
+*       Every code unit that isn't a UTF-8 continuation byte or a UTF-16 low surrogate starts a
+*       character, which is the same as stepping with nextchar() for valid strings. The 8- and
+*       16-bit versions count the characters in 16 bytes at a time, so only the block where the
+*       count runs out is stepped through.
+*/
+template <typename T>
+inline const T * _advancechars(const T *str, const T *end, size_t count)
+{
+    if (sizeof(T) == 4)
+    {
+        return ((size_t)(end - str) > count) ? str + count : end;
+    }
+
+    for ( ; str < end; ++str)
+    {
+        char32_t unit = _codeunit(*str);
+        bool starts = (sizeof(T) == 1) ? ((unit & 0xC0) != 0x80) : ((unit & 0xFC00) != 0xDC00);
+        if (starts)
+        {
+            if (count == 0)
+            {
+                break;
+            }
+
+            count -= 1;
+        }
+    }
+
+    return str;
+}
+
+inline const char * _advancechars(const char *str, const char *end, size_t count)
+{
+#ifdef DRSL_SIMD_SSE2
+    // Continuation bytes are 0x80 to 0xBF, which are the signed values below -64.
+    __m128i continuation_limit = _mm_set1_epi8(-64);
+
+    while (end - str >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+        uint32_t starts = ~(uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(chunk, continuation_limit)) & 0xFFFF;
+
+        size_t chars = _popcount32(starts);
+        if (chars > count)
+        {
+            break;
+        }
+
+        count -= chars;
+        str += 16;
+    }
+#endif
+
+    for ( ; str < end; ++str)
+    {
+        if ((_codeunit(*str) & 0xC0) != 0x80)
+        {
+            if (count == 0)
+            {
+                break;
+            }
+
+            count -= 1;
+        }
+    }
+
+    return str;
+}
+
+inline const char16_t * _advancechars(const char16_t *str, const char16_t *end, size_t count)
+{
+#ifdef DRSL_SIMD_SSE2
+    __m128i surrogate_bits = _mm_set1_epi16((short)0xFC00);
+    __m128i low_surrogate  = _mm_set1_epi16((short)0xDC00);
+
+    while (end - str >= 8)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+        uint32_t starts = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, surrogate_bits), low_surrogate)) & 0xFFFF;
+
+        // Each unit sets two bits.
+        size_t chars = _popcount32(starts) / 2;
+        if (chars > count)
+        {
+            break;
+        }
+
+        count -= chars;
+        str += 8;
+    }
+#endif
+
+    for ( ; str < end; ++str)
+    {
+        if ((_codeunit(*str) & 0xFC00) != 0xDC00)
+        {
+            if (count == 0)
+            {
+                break;
+            }
+
+            count -= 1;
+        }
+    }
+
+    return str;
+}
+
+
+
+/**
+*   \brief              Finds the new lines in a 64 byte block of code units.
+*   \param  block [in]  The start of the block. This is 64 / sizeof(T) code units.
+*   \return             A mask with bit i set if code unit i of the block is a new line.
+*
+*   \remarks
+*       The 8-, 16- and 32-bit versions compare the block 16 bytes at a time and pack the results
+*       down to one bit per code unit, so a whole block of UTF-8 is handled with four compares.
+*/
+template <typename T>
+inline uint64_t _newlinemask(const T *block)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < 64 / sizeof(T); ++i)
+    {
+        if (block[i] == '\n')
+        {
+            mask |= (uint64_t)1 << i;
+        }
+    }
+
+    return mask;
+}
+
+#ifdef DRSL_SIMD_SSE2
+inline uint64_t _newlinemask(const char *block)
+{
+    __m128i new_line = _mm_set1_epi8('\n');
+
+    uint64_t mask0 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)block + 0), new_line));
+    uint64_t mask1 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)block + 1), new_line));
+    uint64_t mask2 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)block + 2), new_line));
+    uint64_t mask3 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)block + 3), new_line));
+
+    return mask0 | (mask1 << 16) | (mask2 << 32) | (mask3 << 48);
+}
+
+inline uint64_t _newlinemask(const char16_t *block)
+{
+    __m128i new_line = _mm_set1_epi16('\n');
+
+    // A match is 0xFFFF, which packs down to a single 0xFF byte.
+    __m128i hit0 = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)block + 0), new_line);
+    __m128i hit1 = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)block + 1), new_line);
+    __m128i hit2 = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)block + 2), new_line);
+    __m128i hit3 = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)block + 3), new_line);
+
+    uint64_t low  = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(hit0, hit1));
+    uint64_t high = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(hit2, hit3));
+
+    return low | (high << 16);
+}
+
+inline uint64_t _newlinemask(const char32_t *block)
+{
+    __m128i new_line = _mm_set1_epi32('\n');
+
+    __m128i hit0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)block + 0), new_line);
+    __m128i hit1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)block + 1), new_line);
+    __m128i hit2 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)block + 2), new_line);
+    __m128i hit3 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)block + 3), new_line);
+
+    __m128i packed = _mm_packs_epi16(_mm_packs_epi32(hit0, hit1), _mm_packs_epi32(hit2, hit3));
+    return (uint32_t)_mm_movemask_epi8(packed);
+}
+#endif
+
+/**
+*   \brief                 Calls a function for each new line in [str, end), in order.
+*   \param  str      [in]  The start of the range to search.
+*   \param  end      [in]  The end of the range to search.
+*   \param  callback [in]  The function object to call. It's given a pointer to each new line.
+*
+*   \remarks
+*       The range is scanned a 64 byte block at a time with _newlinemask(), and the bits of each
+*       block's mask are then walked. Unlike calling _findeither() in a loop, there's no restart
+*       cost per line, which matters when the lines are short. Nothing outside of [str, end) is
+*       ever read.
+*       \par
+*       A new line code unit is never part of a longer UTF-8 or UTF-16 character, so the range
+*       doesn't need to start or end on a character boundary.
+*/
+template <typename T, typename Callback>
+inline void _foreachnewline(const T *str, const T *end, Callback &callback)
+{
+    const size_t block_units = 64 / sizeof(T);
+
+    while ((size_t)(end - str) >= block_units)
+    {
+        uint64_t mask = _newlinemask(str);
+        while (mask != 0)
+        {
+            callback(str + _ctz64(mask));
+            mask &= mask - 1;
+        }
+
+        str += block_units;
+    }
+
+    for ( ; str < end; ++str)
+    {
+        if (*str == '\n')
+        {
+            callback(str);
+        }
+    }
+}
+
+/**
+*   \brief             Counts the new lines in [str, end).
+*
+*   \remarks
+*       This is _foreachnewline() with the bits of each block counted rather than walked.
+*/
+template <typename T>
+inline size_t _countnewlines(const T *str, const T *end)
+{
+    const size_t block_units = 64 / sizeof(T);
+
+    size_t count = 0;
+    while ((size_t)(end - str) >= block_units)
+    {
+        count += _popcount64(_newlinemask(str));
+        str += block_units;
+    }
+
+    for ( ; str < end; ++str)
+    {
+        if (*str == '\n')
+        {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+
+#ifdef DRSL_SIMD_SSE2
+// Bit i is set for each byte i in 'chunk' that is not a new line or a null terminator.
+inline uint32_t _linemask8(__m128i chunk)
+{
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+    return ~(uint32_t)_mm_movemask_epi8(stop) & 0xFFFF;
+}
+
+inline uint32_t _linemask16(__m128i chunk)
+{
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi16(chunk, _mm_set1_epi16('\n')), _mm_cmpeq_epi16(chunk, _mm_setzero_si128()));
+    return ~(uint32_t)_mm_movemask_epi8(stop) & 0xFFFF;
+}
+#endif
+
+/**
+*   \brief             Skips to the end of a line.
+*   \param  str  [in]  The start of the line.
+*   \param  end  [in]  The end of the string, or NULL if the string is null terminated.
+*   \return            A pointer to the first new line or null terminator, or \c end.
+*
+*   \remarks
+*       This is for nextline() on null terminated strings, which can't use _findeither() because
+*       the end isn't known. The 8- and 16-bit versions read 16 bytes at a time. See _skiprun().
+*/
+template <typename T>
+inline const T * _skiptolineend(const T *str, const T *end)
+{
+    while (str != end && *str != '\n' && *str != '\0')
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char * _skiptolineend(const char *str, const char *end)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, end, _linemask8, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (str != end && *str != '\n' && *str != '\0')
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char16_t * _skiptolineend(const char16_t *str, const char16_t *end)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, end, _linemask16, done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (str != end && *str != '\n' && *str != '\0')
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+
+/**
+*   \brief             Finds a code unit in a null terminated string.
+*   \param  str  [in]  The string to search.
+*   \param  unit [in]  The code unit to look for.
+*   \return            A pointer to the first \c unit or the null terminator, whichever comes first.
+*
+*   \remarks
+*       The 8- and 16-bit versions read 16 bytes at a time with aligned loads. See _skiprun().
+*/
+template <typename T>
+inline const T * _findunitornull(const T *str, T unit)
+{
+    while (*str != unit && *str != '\0')
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+#ifdef DRSL_SIMD_SSE2
+// Bit i is set for each byte i in 'chunk' that is neither 'unit' nor a null terminator.
+struct _notunitmask8
+{
+    explicit _notunitmask8(char unit)
+        : unit(_mm_set1_epi8(unit))
+    {
+    }
+
+    uint32_t operator()(__m128i chunk) const
+    {
+        __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(chunk, this->unit), _mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+        return ~(uint32_t)_mm_movemask_epi8(stop) & 0xFFFF;
+    }
+
+    __m128i unit;
+};
+
+struct _notunitmask16
+{
+    explicit _notunitmask16(char16_t unit)
+        : unit(_mm_set1_epi16((short)unit))
+    {
+    }
+
+    uint32_t operator()(__m128i chunk) const
+    {
+        __m128i stop = _mm_or_si128(_mm_cmpeq_epi16(chunk, this->unit), _mm_cmpeq_epi16(chunk, _mm_setzero_si128()));
+        return ~(uint32_t)_mm_movemask_epi8(stop) & 0xFFFF;
+    }
+
+    __m128i unit;
+};
+#endif
+
+inline const char * _findunitornull(const char *str, char unit)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, (const char *)NULL, _notunitmask8(unit), done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (*str != unit && *str != '\0')
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+inline const char16_t * _findunitornull(const char16_t *str, char16_t unit)
+{
+#ifdef DRSL_SIMD_SSE2
+    bool done;
+    str = _skiprun(str, (const char16_t *)NULL, _notunitmask16(unit), done);
+    if (done)
+    {
+        return str;
+    }
+#endif
+
+    while (*str != unit && *str != '\0')
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+
+
+/**
+*   \brief             Copies a run of ASCII bytes into a string of any code unit type.
+*   \param  src  [in]  The start of the bytes.
+*   \param  end  [in]  The end of the bytes.
+*   \param  dest [out] The code units to write to. This needs room for end - src units.
+*   \return            The number of bytes copied, which stops at the first byte that isn't ASCII.
+*
+*   \remarks
+*       ASCII is the same in UTF-8, UTF-16 and UTF-32, so each byte just becomes a code unit. The
+*       8-, 16- and 32-bit versions check and widen 16 bytes at a time.
+*/
+template <typename T>
+inline size_t _widenascii(const unsigned char *src, const unsigned char *end, T *dest)
+{
+    const unsigned char *start = src;
+    while (src < end && *src < 0x80)
+    {
+        *dest++ = (T)*src++;
+    }
+
+    return (size_t)(src - start);
+}
+
+#ifdef DRSL_SIMD_SSE2
+// Copies whole blocks of 16 ASCII bytes with 'widen', then finishes off with the scalar loop.
+template <typename T, typename Widen>
+inline size_t _widenasciiblocks(const unsigned char *src, const unsigned char *end, T *dest, Widen widen)
+{
+    const unsigned char *start = src;
+    while (end - src >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)src);
+        if (_mm_movemask_epi8(chunk) != 0)
+        {
+            break;
+        }
+
+        widen(chunk, dest);
+        src  += 16;
+        dest += 16;
+    }
+
+    return (size_t)(src - start) + _widenascii<T>(src, end, dest);
+}
+
+inline void _widen8(__m128i chunk, char *dest)
+{
+    _mm_storeu_si128((__m128i *)dest, chunk);
+}
+
+inline void _widen16(__m128i chunk, char16_t *dest)
+{
+    __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i *)dest + 0, _mm_unpacklo_epi8(chunk, zero));
+    _mm_storeu_si128((__m128i *)dest + 1, _mm_unpackhi_epi8(chunk, zero));
+}
+
+inline void _widen32(__m128i chunk, char32_t *dest)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i low  = _mm_unpacklo_epi8(chunk, zero);
+    __m128i high = _mm_unpackhi_epi8(chunk, zero);
+    _mm_storeu_si128((__m128i *)dest + 0, _mm_unpacklo_epi16(low,  zero));
+    _mm_storeu_si128((__m128i *)dest + 1, _mm_unpackhi_epi16(low,  zero));
+    _mm_storeu_si128((__m128i *)dest + 2, _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128((__m128i *)dest + 3, _mm_unpackhi_epi16(high, zero));
+}
+
+inline size_t _widenascii(const unsigned char *src, const unsigned char *end, char *dest)
+{
+    return _widenasciiblocks(src, end, dest, _widen8);
+}
+
+inline size_t _widenascii(const unsigned char *src, const unsigned char *end, char16_t *dest)
+{
+    return _widenasciiblocks(src, end, dest, _widen16);
+}
+
+inline size_t _widenascii(const unsigned char *src, const unsigned char *end, char32_t *dest)
+{
+    return _widenasciiblocks(src, end, dest, _widen32);
+}
+#endif
+
+
+
+/**
+*   \brief                  Copies a run of UTF-16 code units that need no decoding into a string of any code unit type.
+*   \param  src       [in]  The start of the bytes.
+*   \param  end       [in]  The end of the bytes.
+*   \param  bigEndian [in]  Whether or not the code units are big-endian.
+*   \param  dest      [out] The code units to write to. This needs room for (end - src) / 2 units.
+*   \return                 The number of bytes copied. This is always a whole number of code units.
+*
+*   \remarks
+*       Copying stops at the first surrogate, which needs pairing up, or for 8-bit T's at the
+*       first unit outside of ASCII. The 8-, 16- and 32-bit versions convert 8 code units at a
+*       time, and swap the bytes of big-endian units in the same pass, so opposite-endian text
+*       never needs swapping into a separate buffer first.
+*/
+template <typename T>
+inline size_t _widenutf16(const unsigned char *src, const unsigned char *end, bool bigEndian, T *dest)
+{
+    const unsigned char *start = src;
+    while (end - src >= 2)
+    {
+        char32_t unit = bigEndian ? (((char32_t)src[0] << 8) | src[1]) : (src[0] | ((char32_t)src[1] << 8));
+
+        bool simple = (sizeof(T) == 1) ? (unit < 0x80) : (unit < 0xD800 || unit > 0xDFFF);
+        if (!simple)
+        {
+            break;
+        }
+
+        *dest++ = (T)unit;
+        src += 2;
+    }
+
+    return (size_t)(src - start);
+}
+
+#ifdef DRSL_SIMD_SSE2
+// Converts whole blocks of 8 code units with 'store', which returns false if the block has a unit
+// that needs decoding. The scalar loop finishes off the rest.
+template <typename T, typename Store>
+inline size_t _widenutf16blocks(const unsigned char *src, const unsigned char *end, bool bigEndian, T *dest, Store store)
+{
+    const unsigned char *start = src;
+    while (end - src >= 16)
+    {
+        __m128i units = _mm_loadu_si128((const __m128i *)src);
+        if (bigEndian)
+        {
+            units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+        }
+
+        if (!store(units, dest))
+        {
+            break;
+        }
+
+        src  += 16;
+        dest += 8;
+    }
+
+    return (size_t)(src - start) + _widenutf16<T>(src, end, bigEndian, dest);
+}
+
+// Whether or not any of the 16-bit units is a surrogate.
+inline bool _hassurrogate16(__m128i units)
+{
+    __m128i surrogate = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800));
+    return _mm_movemask_epi8(surrogate) != 0;
+}
+
+inline bool _storeutf16as8(__m128i units, char *dest)
+{
+    __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xFF80)), _mm_setzero_si128());
+    if (_mm_movemask_epi8(ascii) != 0xFFFF)
+    {
+        return false;
+    }
+
+    _mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(units, units));
+    return true;
+}
+
+inline bool _storeutf16as16(__m128i units, char16_t *dest)
+{
+    if (_hassurrogate16(units))
+    {
+        return false;
+    }
+
+    _mm_storeu_si128((__m128i *)dest, units);
+    return true;
+}
+
+inline bool _storeutf16as32(__m128i units, char32_t *dest)
+{
+    if (_hassurrogate16(units))
+    {
+        return false;
+    }
+
+    __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i *)dest + 0, _mm_unpacklo_epi16(units, zero));
+    _mm_storeu_si128((__m128i *)dest + 1, _mm_unpackhi_epi16(units, zero));
+    return true;
+}
+
+inline size_t _widenutf16(const unsigned char *src, const unsigned char *end, bool bigEndian, char *dest)
+{
+    return _widenutf16blocks(src, end, bigEndian, dest, _storeutf16as8);
+}
+
+inline size_t _widenutf16(const unsigned char *src, const unsigned char *end, bool bigEndian, char16_t *dest)
+{
+    return _widenutf16blocks(src, end, bigEndian, dest, _storeutf16as16);
+}
+
+inline size_t _widenutf16(const unsigned char *src, const unsigned char *end, bool bigEndian, char32_t *dest)
+{
+    return _widenutf16blocks(src, end, bigEndian, dest, _storeutf16as32);
+}
+#endif
+
+
+}
+
+#endif // DRSL_SIMD
@@ -19,6 +19,9 @@ namespace drsl
 *       The destination buffer must be NULL terminated to indicate the end of the string.
 *       \par
 *       If an error occurs, 0 is returned.
+*       \par
+*       Each call looks through \c dest again to find its end. To join several strings, use
+*       concat() or string_builder instead, which measure each piece once.
 */
 template <typename T>
 size_t append(T *dest, const T *source, size_t destSize = -1, size_t destLength = -1, size_t sourceLength = -1)
@@ -45,6 +45,41 @@ inline char32_t skipbom(T *&str)
     return 0;
 }
 
+/**
+*   \brief           Skips over the BOM of a string that isn't null terminated.
+*   \param  str [in] The string whose BOM should be skipped over.
+*   \param  end [in] The end of the string.
+*   \return          The BOM if the string has one, or 0 if it doesn't.
+*
+*   \remarks
+*       This is the same as skipbom() above, except that nothing at or past \c end is read. The
+*       code units are compared against the encoded BOM rather than decoded, so a partial
+*       character at the end is never looked past.
+*/
+template <typename T>
+inline char32_t skipbom(T *&str, T *end)
+{
+    // The BOM is EF BB BF in UTF-8, and a single code unit otherwise.
+    static const char32_t utf8_bom[3] = {0xEF, 0xBB, 0xBF};
+    size_t bom_length = (sizeof(T) == 1) ? 3 : 1;
+
+    if (str > end || (size_t)(end - str) < bom_length)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < bom_length; ++i)
+    {
+        if (_codeunit(str[i]) != ((sizeof(T) == 1) ? utf8_bom[i] : 0xFEFF))
+        {
+            return 0;
+        }
+    }
+
+    str += bom_length;
+    return 0xFEFF;
+}
+
 /**
 *   \brief                      Attaches the BOM to the start of the specified string.
 *   \param  str       [in, out] The string to attach the BOM to.
@@ -0,0 +1,217 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_BYTESWAPPED
+#define DRSL_BYTESWAPPED
+
+namespace drsl
+{
+
+inline char16_t _byteswap(char16_t unit)
+{
+    return (char16_t)((unit << 8) | (unit >> 8));
+}
+
+inline char32_t _byteswap(char32_t unit)
+{
+    return (unit << 24) | ((unit << 8) & 0x00FF0000) | ((unit >> 8) & 0x0000FF00) | (unit >> 24);
+}
+
+
+/**
+*   \brief  A UTF-16 or UTF-32 code unit stored in the opposite byte order to the machine's.
+*
+*   A pointer to byteswapped<char16_t> or byteswapped<char32_t> can be used as a string with the
+*   rest of the library, so text read from a big-endian file or network buffer on a little-endian
+*   machine (or the other way around) can be searched and measured where it is. Each unit is
+*   swapped as it's read, and there is never a swapped copy of the whole string. For example:
+*
+*       const byteswapped<char16_t> *str = (const byteswapped<char16_t> *)data;
+*       const byteswapped<char16_t> *end = str + size / 2;
+*
+*       size_t count = charcount(str, end - str);
+*       const byteswapped<char16_t> *found = findfirst(str, u"error", end - str);
+*
+*   nextchar(), getchar(), charcount(), findfirst() and copy() all work on them, and copy() into a
+*   native string converts in the same pass. Writing goes the other way: copying a native string
+*   into a byteswapped<char16_t> string produces opposite-endian UTF-16.
+*
+*   To convert a whole buffer in one go, text_decoder with TEXT_ENCODING_UTF16BE or
+*   TEXT_ENCODING_UTF16LE is faster, since it swaps 8 code units at a time as it converts.
+*/
+template <typename T>
+struct byteswapped
+{
+    /// The code unit as it's stored.
+    T raw;
+
+    /**
+    *   \brief  Retrieves the code unit in the machine's byte order.
+    */
+    operator T() const
+    {
+        return _byteswap(this->raw);
+    }
+
+    /**
+    *   \brief  Stores a code unit given in the machine's byte order.
+    */
+    byteswapped & operator=(T unit)
+    {
+        this->raw = _byteswap(unit);
+        return *this;
+    }
+};
+
+
+// \copydoc nextchar(const char *&)
+inline char32_t nextchar(const byteswapped<char16_t> *&str)
+{
+    assert(str != NULL);
+
+    char32_t ch = (char16_t)str[0];
+    if (ch == 0)
+    {
+        return 0;
+    }
+
+    if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+    {
+        // The high surrogate must be followed by a low surrogate, which also stops us going past
+        // the null terminator.
+        char32_t ch2 = (char16_t)str[1];
+        if (ch2 < UNI_SUR_LOW_START || ch2 > UNI_SUR_LOW_END)
+        {
+            return 0;
+        }
+
+        ch = ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (ch2 - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+        str += 2;
+    }
+    else
+    {
+        str += 1;
+    }
+
+    return ch;
+}
+
+// \copydoc nextchar(const char *&)
+inline char32_t nextchar(const byteswapped<char32_t> *&str)
+{
+    assert(str != NULL);
+
+    char32_t ch = (char32_t)str[0];
+    if (ch != 0)
+    {
+        ++str;
+    }
+
+    return ch;
+}
+
+
+// \copydoc writechar(char *, char32_t)
+inline size_t writechar(byteswapped<char16_t> *&dest, char32_t character)
+{
+    char16_t units[2];
+    char16_t *temp = units;
+
+    size_t count = writechar(temp, character);
+    if (dest != NULL)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            *dest++ = units[i];
+        }
+    }
+
+    return count;
+}
+
+// \copydoc writechar(char *, char32_t)
+inline size_t writechar(byteswapped<char32_t> *&dest, char32_t character)
+{
+    char32_t unit;
+    char32_t *temp = &unit;
+
+    size_t count = writechar(temp, character);
+    if (dest != NULL)
+    {
+        *dest++ = unit;
+    }
+
+    return count;
+}
+
+
+/**
+*   \brief                  Finds a native string from within a byte swapped string.
+*   \param  str1       [in] The byte swapped string to be scanned.
+*   \param  str2       [in] The string to look for inside \c str1, in the machine's byte order.
+*   \param  str1Length [in] The length in units of the first string, not including the null terminator.
+*   \param  str2Length [in] The length in T's of the second string, not including the null terminator.
+*   \return                 A pointer to the first occurance of \c str2; or NULL if the string is not found.
+*
+*   \remarks
+*       The code units are compared as they're stored, with \c str2 swapped to match, so nothing in
+*       \c str1 is swapped or decoded.
+*/
+template <typename T>
+inline const byteswapped<T> * findfirst(const byteswapped<T> *str1, const T *str2, size_t str1Length = -1, size_t str2Length = -1)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
+
+    if (str2Length == (size_t)-1)
+    {
+        str2Length = length(str2);
+    }
+
+    if (str2Length == 0)
+    {
+        return str1;
+    }
+
+    const T first = _byteswap(str2[0]);
+    for (size_t i = 0; i < str1Length && str1[i].raw != 0; ++i)
+    {
+        if (str1[i].raw != first)
+        {
+            continue;
+        }
+
+        // A null terminator in str1 never matches, since str2 has none before str2Length.
+        size_t j = 1;
+        while (j < str2Length && i + j < str1Length && str1[i + j].raw == _byteswap(str2[j]))
+        {
+            ++j;
+        }
+
+        if (j == str2Length)
+        {
+            return str1 + i;
+        }
+    }
+
+    return NULL;
+}
+
+template <typename T>
+inline byteswapped<T> * findfirst(byteswapped<T> *str1, const T *str2, size_t str1Length = -1, size_t str2Length = -1)
+{
+    return (byteswapped<T> *)findfirst((const byteswapped<T> *)str1, str2, str1Length, str2Length);
+}
+
+
+template <> inline size_t charwidth<byteswapped<char16_t> >(char32_t character)
+{
+    return charwidth<char16_t>(character);
+}
+template <> inline size_t charwidth<byteswapped<char32_t> >(char32_t character)
+{
+    return charwidth<char32_t>(character);
+}
+
+}
+
+#endif // DRSL_BYTESWAPPED
@@ -0,0 +1,286 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_CONCAT
+#define DRSL_CONCAT
+
+namespace drsl
+{
+
+/**
+*   \brief  One of the pieces passed to concat() or string_builder::append(), measured and ready to be copied.
+*/
+template <typename T>
+struct _concat_piece
+{
+    /// The text when it's already made of T's. For numbers and characters this points to 'digits'.
+    const T *text;
+
+    /// The text when it's in another encoding, or NULL.
+    const void *foreignText;
+
+    /// The size in bytes of each code unit of 'foreignText'. This is what decides its encoding.
+    size_t foreignUnitSize;
+
+    /// The length of the text in its own code units.
+    size_t length;
+
+    /// The number of T's the piece takes up in the result.
+    size_t size;
+
+    /// Numbers and characters, written out while they're measured.
+    T digits[32];
+};
+
+
+// Finds where both passes over a string in another encoding stop, which is at the first null or at
+// 'end'. Fixing this up front matters because the ASCII fast path in _transcode() copies nulls like
+// any other ASCII, so it would otherwise write more than _transcodedsize() counted.
+template <typename U>
+inline const U * _transcodeend(const U *str, const U *end)
+{
+    if (sizeof(U) == 1)
+    {
+        const void *null_char = memchr(str, 0, (size_t)(end - str));
+        return (null_char != NULL) ? (const U *)null_char : end;
+    }
+
+    while (str < end && *str != 0)
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+// Counts the T's needed for a string in another encoding. Characters that can't be written as T's
+// take up the replacement character, the same as copy().
+template <typename T, typename U>
+inline size_t _transcodedsize(const U *str, const U *end)
+{
+    size_t size = 0;
+
+    char32_t ch;
+    while (str < end && (ch = nextchar(str)) != '\0' && str <= end)
+    {
+        size_t char_width = charwidth<T>(ch);
+        if (char_width == 0)
+        {
+            char_width = charwidth<T>(UNI_REPLACEMENT_CHAR);
+        }
+
+        size += char_width;
+    }
+
+    return size;
+}
+
+// Writes a string in another encoding as T's, returning the end of what was written. This stops
+// in the same place as _transcodedsize(), so it writes exactly that many T's.
+template <typename T, typename U>
+inline T * _transcode(T *dest, const U *str, const U *end)
+{
+    while (str < end)
+    {
+        if (sizeof(U) == 1)
+        {
+            // Runs of ASCII are copied 16 bytes at a time.
+            size_t count = _widenascii((const unsigned char *)str, (const unsigned char *)end, dest);
+            str  += count;
+            dest += count;
+
+            if (str == end)
+            {
+                break;
+            }
+        }
+
+        char32_t ch = nextchar(str);
+        if (ch == '\0' || str > end)
+        {
+            break;
+        }
+
+        writechar(dest, ch);
+    }
+
+    return dest;
+}
+
+
+template <typename T>
+inline void _setpiecetext(_concat_piece<T> &piece, const T *str, size_t strLength)
+{
+    piece.text   = str;
+    piece.length = strLength;
+    piece.size   = strLength;
+}
+
+template <typename T, typename U>
+inline void _setpiecetext(_concat_piece<T> &piece, const U *str, size_t strLength)
+{
+    const U *end = _transcodeend(str, str + strLength);
+
+    piece.foreignText     = str;
+    piece.foreignUnitSize = sizeof(U);
+    piece.length          = (size_t)(end - str);
+    piece.size            = _transcodedsize<T>(str, end);
+}
+
+template <typename T>
+inline void _setpiececharacter(_concat_piece<T> &piece, char32_t character)
+{
+    T *dest = piece.digits;
+    piece.text = piece.digits;
+    piece.size = writechar(dest, character);
+}
+
+template <typename T, typename U>
+inline void _setpiecenumber(_concat_piece<T> &piece, U value)
+{
+    piece.text = piece.digits;
+    piece.size = tostring(value, piece.digits, sizeof(piece.digits) / sizeof(T)) - 1;
+}
+
+
+// Measures each kind of piece. A NULL string is treated as an empty one.
+template <typename T, typename U>
+inline void _measurepiece(_concat_piece<T> &piece, const U *str)
+{
+    if (str != NULL)
+    {
+        _setpiecetext(piece, str, length(str));
+    }
+}
+
+template <typename T, typename U>
+inline void _measurepiece(_concat_piece<T> &piece, const reference_string<U> &str)
+{
+    _setpiecetext(piece, (const U *)str.start, length(str));
+}
+
+template <typename T, typename U>
+inline void _measurepiece(_concat_piece<T> &piece, const slow_string<U> &str)
+{
+    _measurepiece(piece, str.c_str());
+}
+
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, char value)               { _setpiececharacter(piece, (unsigned char)value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, char16_t value)           { _setpiececharacter(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, char32_t value)           { _setpiececharacter(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, wchar_t value)            { _setpiececharacter(piece, (char32_t)value); }
+
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, signed char value)        { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, unsigned char value)      { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, short value)              { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, unsigned short value)     { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, int value)                { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, unsigned int value)       { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, long value)               { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, unsigned long value)      { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, long long value)          { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, unsigned long long value) { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, float value)              { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, double value)             { _setpiecenumber(piece, value); }
+template <typename T> inline void _measurepiece(_concat_piece<T> &piece, bool value)               { _setpiecenumber(piece, value); }
+
+
+// Measures every piece, returning the total number of T's they take up.
+template <typename T>
+inline size_t _measurepieces(_concat_piece<T> *)
+{
+    return 0;
+}
+
+template <typename T, typename Part, typename... Parts>
+inline size_t _measurepieces(_concat_piece<T> *pieces, const Part &part, const Parts &... parts)
+{
+    pieces[0].text        = NULL;
+    pieces[0].foreignText = NULL;
+    pieces[0].length      = 0;
+    pieces[0].size        = 0;
+    _measurepiece(pieces[0], part);
+
+    return pieces[0].size + _measurepieces(pieces + 1, parts...);
+}
+
+// Writes every piece, returning the end of what was written. 'dest' needs room for the total from
+// _measurepieces().
+template <typename T>
+inline T * _writepieces(T *dest, const _concat_piece<T> *pieces, size_t pieceCount)
+{
+    for (size_t iPiece = 0; iPiece < pieceCount; ++iPiece)
+    {
+        const _concat_piece<T> &piece = pieces[iPiece];
+
+        if (piece.foreignText == NULL)
+        {
+            if (piece.size > 0)
+            {
+                memcpy(dest, piece.text, piece.size * sizeof(T));
+                dest += piece.size;
+            }
+        }
+        else
+        {
+            switch (piece.foreignUnitSize)
+            {
+            case 1: dest = _transcode(dest, (const char *)piece.foreignText, (const char *)piece.foreignText + piece.length); break;
+            case 2: dest = _transcode(dest, (const char16_t *)piece.foreignText, (const char16_t *)piece.foreignText + piece.length); break;
+            case 4: dest = _transcode(dest, (const char32_t *)piece.foreignText, (const char32_t *)piece.foreignText + piece.length); break;
+            }
+        }
+    }
+
+    return dest;
+}
+
+
+/**
+*   \brief                 Joins any number of strings, characters and numbers into a buffer.
+*   \param  dest     [out] The buffer that will receive the joined string. Can be NULL.
+*   \param  destSize [in]  The size in T's of the buffer pointed to by \c dest.
+*   \param  parts    [in]  The pieces to join, in order.
+*   \return                The number of T's required to store the joined string, including the null terminator.
+*
+*   \remarks
+*       Each piece can be a null terminated string of any character type, a reference_string or
+*       slow_string of any character type, a single char, char16_t, char32_t or wchar_t character,
+*       or a number or bool, which is written the same as tostring(). Strings in another encoding
+*       are converted as they're copied.
+*       \par
+*       The size of every piece is worked out once, up front, and each piece is then copied
+*       straight to its place in \c dest. Lengths of null terminated strings are only found once,
+*       and numbers are only formatted once. Unlike chaining append() calls, nothing already in
+*       \c dest is looked at again. For example:
+*
+*           char path[256];
+*           concat(path, 256, directory, '/', name, '_', index, ".txt");
+*       \par
+*       If \c dest is NULL, or \c destSize is too small to store the whole string, nothing is
+*       written other than a null terminator (when there is room for one), and the required
+*       size is returned.
+*/
+template <typename T, typename... Parts>
+size_t concat(T *dest, size_t destSize, const Parts &... parts)
+{
+    _concat_piece<T> pieces[sizeof...(Parts) + 1];
+    size_t total = _measurepieces(pieces, parts...);
+
+    if (dest == NULL || destSize < total + 1)
+    {
+        if (dest != NULL && destSize > 0)
+        {
+            dest[0] = '\0';
+        }
+
+        return total + 1;
+    }
+
+    *_writepieces(dest, pieces, sizeof...(Parts)) = '\0';
+
+    return total + 1;
+}
+
+}
+
+#endif // DRSL_CONCAT
@@ -12,13 +12,18 @@
 #include <locale.h>
 #include <assert.h>
 #include <ctype.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 #include <ostream>
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <thread>
 
 #include "setup.hpp"
 #include "_private.hpp"
+#include "_simd.hpp"
 #include "reference_string.hpp"
 #include "nextchar.hpp"
 #include "getchar.hpp"
@@ -28,19 +33,37 @@
 #include "find.hpp"
 #include "writechar.hpp"
 #include "copy.hpp"
+#include "byteswapped.hpp"
 #include "format.hpp"
+
+#include "numeric/_private.hpp"
+#include "numeric/_ryu_tables.hpp"
+#include "numeric/_ryu.hpp"
+#include "numeric/_decimal.hpp"
+#include "numeric/floattostring.hpp"
+#include "numeric/inttostring.hpp"
+
+#include "tryparse.hpp"
 #include "parse.hpp"
+
 #include "tostring.hpp"
 #include "slow_string.hpp"
 #include "string.hpp"
 #include "bom.hpp"
+#include "mapped_text.hpp"
+#include "text_decoder.hpp"
 #include "append.hpp"
+#include "concat.hpp"
+#include "string_builder.hpp"
 #include "nextline.hpp"
+#include "line_index.hpp"
 #include "stream_output.hpp"
 #include "erase.hpp"
 #include "istype.hpp"
 #include "replace.hpp"
+#include "multi_replacer.hpp"
 #include "split.hpp"
+#include "parsecolumns.hpp"
 
 #include "paths/_private.hpp"
 #include "paths/getfileext.hpp"
@@ -53,7 +76,14 @@
 
 #include "tokens/_private.hpp"
 #include "tokens/nexttoken.hpp"
+#include "tokens/token_array.hpp"
 #include "tokens/extracttokens.hpp"
+#include "tokens/parallelextracttokens.hpp"
+#include "tokens/token_range.hpp"
+#include "tokens/keyword_table.hpp"
+#include "tokens/compiled_tokenizer.hpp"
+#include "tokens/token_cursor.hpp"
+#include "tokens/token_stream.hpp"
 
 #include "search/containsprintablechar.hpp"
 #include "search/containsnonprintablechar.hpp"
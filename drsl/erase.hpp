@@ -6,6 +6,19 @@
 namespace drsl
 {
 
+/**
+*   \brief  Structure describing a range of characters in a string.
+*/
+struct CHAR_RANGE
+{
+    /// The index of the first character in the range.
+    size_t start;
+
+    /// The number of characters in the range.
+    size_t count;
+};
+
+
 /**
 *   \brief                      Removes a section of a given string.
 *   \param  str       [in, out] The string whose section is to be removed.
@@ -19,44 +32,114 @@ namespace drsl
 template <typename T>
 inline void erase(T *str, size_t start, size_t count, size_t strLength = -1)
 {
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
     // This assertion checks that we aren't trying to erase past the end of the string.
     // The function won't crash in release builds, but it's good to have this here to
     // ensure correctness.
-    assert(start + count <= ((strLength != -1) ? strLength : length(str)));
+    assert(start + count <= strLength);
+
+    T *end = str + strLength;
+
+    // Find the characters to remove, then move the rest of the string down over them. The string
+    // stays in the same encoding, so there's no need to decode and re-encode it.
+    T *first = str + (_advancechars(str, end, start) - str);
+    T *last  = first + (_advancechars(first, end, count) - first);
 
-    // Stores the length of the string before the index of the last character to remove.
-    size_t temp_length = start + count;
+    memmove(first, last, (size_t)(end - last) * sizeof(T));
 
-    // We need to move our input string to the first character that we're removing.
-    while (start > 0)
+    // Null terminate.
+    first[end - last] = '\0';
+}
+
+template <typename T>
+inline void erase(reference_string<T> &str, size_t start, size_t count)
+{
+    return erase(str.start, start, count, length(str));
+}
+
+
+/**
+*   \brief                       Removes several sections of a string in one pass.
+*   \param  str        [in, out] The string whose sections are to be removed.
+*   \param  ranges     [in]      The ranges of characters to remove, in order of their start.
+*   \param  rangeCount [in]      The number of items in \c ranges.
+*   \param  strLength  [in]      The length in T's of the input string, not including the null terminator.
+*   \return                      The length in T's of the string once the sections have been removed.
+*
+*   \remarks
+*       The character indices in \c ranges all refer to the original string, so this is not the
+*       same as calling erase() for each range in turn. Ranges can overlap or touch, in which case
+*       the union is removed, and parts of ranges that go past the end of the string are ignored.
+*       \par
+*       The string is compacted in a single pass, with each part between two ranges moved down
+*       once. Characters are counted 16 bytes at a time to find each range. The result is null
+*       terminated if anything was removed, or if \c strLength was not given.
+*/
+template <typename T>
+size_t eraseranges(T *str, const CHAR_RANGE *ranges, size_t rangeCount, size_t strLength = -1)
+{
+    assert(str != NULL);
+    assert(ranges != NULL || rangeCount == 0);
+
+    bool null_terminated = false;
+    if (strLength == (size_t)-1)
     {
-        nextchar(str);
-        --start;
+        strLength = length(str);
+        null_terminated = true;
     }
 
-    // Now we need to get to the last character that we're removing.
-    T *end = str;
-    while (count > 0)
+    const T *end = str + strLength;
+
+    // The part of the string still to be looked at starts at 'read', which is the character at
+    // 'index' in the original string. Everything kept so far has been moved down to before 'write'.
+    const T *read = str;
+    size_t index = 0;
+    T *write = str;
+
+    for (size_t iRange = 0; iRange < rangeCount && read < end; ++iRange)
     {
-        nextchar(end);
-        --count;
+        assert(iRange == 0 || ranges[iRange].start >= ranges[iRange - 1].start);
+
+        size_t range_end = ranges[iRange].start + ranges[iRange].count;
+        if (range_end <= index)
+        {
+            continue;
+        }
+
+        if (ranges[iRange].start > index)
+        {
+            const T *kept_end = _advancechars(read, end, ranges[iRange].start - index);
+            if (write != read)
+            {
+                memmove(write, read, (size_t)(kept_end - read) * sizeof(T));
+            }
+
+            write += kept_end - read;
+            read   = kept_end;
+            index  = ranges[iRange].start;
+        }
+
+        read  = _advancechars(read, end, range_end - index);
+        index = range_end;
     }
 
-    // Now we need to write each character after 'end' to the string.
-    char32_t ch;
-    while (strLength - temp_length > 0 && (ch = nextchar(end)) != '\0')
+    if (write != read)
     {
-        writechar(str, ch);
+        memmove(write, read, (size_t)(end - read) * sizeof(T));
     }
 
-    // Null terminate.
-    *str = '\0';
-}
+    write += end - read;
 
-template <typename T>
-inline void erase(reference_string<T> &str, size_t start, size_t count)
-{
-    return erase(str.start, start, count, length(str));
+    if (null_terminated || write < end)
+    {
+        *write = '\0';
+    }
+
+    return (size_t)(write - str);
 }
 
 }
@@ -226,4 +226,124 @@ inline wchar_t * findfirstof(wchar_t *str, const wchar_t *charSet)
     return ::wcspbrk(str, charSet);
 }
 
+/**
+*   \brief  Finds each occurrence of a substring in a string, for functions that search for the same one many times.
+*
+*   The substring is matched code unit by code unit. Because UTF-8 and UTF-16 are self
+*   synchronizing, a valid substring can only ever match at the start of a character. The scan
+*   for the first code unit of the substring is done 16 bytes at a time where SIMD is available.
+*/
+template <typename T>
+class _substring_finder
+{
+public:
+
+    _substring_finder()
+        : pattern(NULL), patternLength(0)
+    {
+    }
+
+    _substring_finder(const T *pattern, size_t patternLength)
+        : pattern(pattern), patternLength(patternLength)
+    {
+        assert(pattern != NULL);
+
+        if (this->patternLength == (size_t)-1)
+        {
+            this->patternLength = length(pattern);
+        }
+
+        // An empty substring would match everywhere without moving forward.
+        assert(this->patternLength > 0);
+    }
+
+    // Returns the first occurrence of the substring in [str, end), or 'end' if there isn't one.
+    const T * find(const T *str, const T *end) const
+    {
+        T first = this->pattern[0];
+        while ((size_t)(end - str) >= this->patternLength)
+        {
+            const T *last_start = end - this->patternLength + 1;
+
+            str = _findeither(str, last_start, first, first);
+            if (str == last_start)
+            {
+                break;
+            }
+
+            size_t i = 1;
+            while (i < this->patternLength && str[i] == this->pattern[i])
+            {
+                ++i;
+            }
+
+            if (i == this->patternLength)
+            {
+                return str;
+            }
+
+            ++str;
+        }
+
+        return end;
+    }
+
+    // The same as find() for a null terminated string. Returns the null terminator if the substring
+    // isn't found.
+    const T * findterminated(const T *str) const
+    {
+        T first = this->pattern[0];
+        for ( ; ; )
+        {
+            str = _findunitornull(str, first);
+            if (*str == '\0')
+            {
+                return str;
+            }
+
+            // The substring has no null in it, so this stops at the terminator.
+            size_t i = 1;
+            while (i < this->patternLength && str[i] == this->pattern[i])
+            {
+                ++i;
+            }
+
+            if (i == this->patternLength)
+            {
+                return str;
+            }
+
+            ++str;
+        }
+    }
+
+    // Counts the occurrences of the substring in [str, end) that don't overlap.
+    size_t count(const T *str, const T *end) const
+    {
+        size_t result = 0;
+        while ((str = this->find(str, end)) != end)
+        {
+            result += 1;
+            str += this->patternLength;
+        }
+
+        return result;
+    }
+
+    size_t size() const
+    {
+        return this->patternLength;
+    }
+
+
+private:
+
+    /// The substring.
+    const T *pattern;
+
+    /// The length in T's of the substring.
+    size_t patternLength;
+};
+
+
 }
\ No newline at end of file
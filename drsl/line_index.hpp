@@ -0,0 +1,335 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_LINEINDEX
+#define DRSL_LINEINDEX
+
+namespace drsl
+{
+
+/**
+*   \brief  Structure describing a position in a string in terms of lines and columns.
+*
+*   Everything is zero based. Lines are separated by new-line characters; a carriage return
+*   before a new line is counted as the last character of its line.
+*/
+struct TEXT_POSITION
+{
+    /// The offset in T's from the start of the string.
+    size_t offset;
+
+    /// The line.
+    size_t line;
+
+    /// The column, in characters (code points).
+    size_t column;
+
+    /// The column, in T's.
+    size_t columnUnits;
+};
+
+
+/**
+*   \brief  Determines whether or not a code unit is the first unit of a character.
+*
+*   \remarks
+*       This is false for UTF-8 continuation bytes and UTF-16 low surrogates.
+*/
+template <typename T>
+inline bool _startschar(T unit)
+{
+    if (sizeof(T) == 1)
+    {
+        return (_codeunit(unit) & 0xC0) != 0x80;
+    }
+
+    if (sizeof(T) == 2)
+    {
+        return (_codeunit(unit) & 0xFC00) != 0xDC00;
+    }
+
+    return true;
+}
+
+/**
+*   \brief  Counts the characters in [str, end) by counting the units that start a character.
+*/
+template <typename T>
+inline size_t _countchars(const T *str, const T *end)
+{
+    if (sizeof(T) == 4)
+    {
+        return (size_t)(end - str);
+    }
+
+    size_t count = 0;
+    for ( ; str < end; ++str)
+    {
+        if (_startschar(*str))
+        {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+
+/**
+*   \brief  Class for mapping offsets in a string to lines and columns.
+*
+*   The index stores the offset of the start of each line, so the line of an offset is found
+*   with a binary search. The string itself is referenced, not copied, so it must stay around for
+*   as long as the index is used.
+*/
+template <typename T>
+class line_index
+{
+public:
+
+    /**
+    *   \brief  Default constructor. The index is empty until build() is called.
+    */
+    line_index()
+        : str(NULL), strLength(0), lineStarts()
+    {
+    }
+
+    /**
+    *   \brief                   Constructor.
+    *   \param  str         [in] The string to index.
+    *   \param  strLength   [in] The length in T's of the string, not including the null terminator.
+    *   \param  threadCount [in] The number of threads to build the index with. See build().
+    */
+    explicit line_index(const T *str, size_t strLength = -1, unsigned int threadCount = 1)
+        : str(NULL), strLength(0), lineStarts()
+    {
+        this->build(str, strLength, threadCount);
+    }
+
+
+    /**
+    *   \brief                   Builds the index for the specified string, replacing the existing one.
+    *   \param  str         [in] The string to index.
+    *   \param  strLength   [in] The length in T's of the string, not including the null terminator.
+    *   \param  threadCount [in] The number of threads to use, including the calling thread. 0 means one per hardware thread.
+    *
+    *   \remarks
+    *       The string is scanned for new lines 64 bytes at a time. With more than one thread, the
+    *       string is split into equal parts which are scanned at the same time and then joined.
+    *       The split points don't need to be on line or character boundaries. Strings under a
+    *       megabyte are always scanned on the calling thread.
+    */
+    void build(const T *str, size_t strLength = -1, unsigned int threadCount = 1)
+    {
+        assert(str != NULL);
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = length(str);
+        }
+
+        this->str = str;
+        this->strLength = strLength;
+
+        this->lineStarts.clear();
+        this->lineStarts.push_back(0);
+
+        if (threadCount == 0)
+        {
+            threadCount = std::thread::hardware_concurrency();
+        }
+
+        if (threadCount > strLength / (512 * 1024))
+        {
+            threadCount = (unsigned int)(strLength / (512 * 1024));
+        }
+
+        if (threadCount <= 1)
+        {
+            _indexlines(str, str, str + strLength, &this->lineStarts);
+            return;
+        }
+
+
+        std::vector<std::vector<size_t> > parts(threadCount);
+        std::vector<std::thread> threads;
+        for (unsigned int iPart = 1; iPart < threadCount; ++iPart)
+        {
+            const T *part_start = str + (strLength / threadCount) * iPart;
+            const T *part_end   = (iPart + 1 < threadCount) ? str + (strLength / threadCount) * (iPart + 1) : str + strLength;
+            threads.push_back(std::thread(_indexlines, str, part_start, part_end, &parts[iPart]));
+        }
+
+        _indexlines(str, str, str + (strLength / threadCount), &this->lineStarts);
+
+        for (size_t iThread = 0; iThread < threads.size(); ++iThread)
+        {
+            threads[iThread].join();
+        }
+
+        for (unsigned int iPart = 1; iPart < threadCount; ++iPart)
+        {
+            this->lineStarts.insert(this->lineStarts.end(), parts[iPart].begin(), parts[iPart].end());
+        }
+    }
+
+
+    /**
+    *   \brief  Retrieves the number of lines in the string.
+    *
+    *   \remarks
+    *       This is one more than the number of new-line characters, so a string ending with a new
+    *       line has an empty last line.
+    */
+    size_t linecount() const
+    {
+        return this->lineStarts.size();
+    }
+
+    /**
+    *   \brief            Retrieves the offset in T's of the start of the specified line.
+    *   \param  line [in] The zero based line.
+    */
+    size_t linestart(size_t line) const
+    {
+        assert(line < this->lineStarts.size());
+        return this->lineStarts[line];
+    }
+
+    /**
+    *   \brief            Retrieves the offset in T's of the end of the specified line.
+    *   \param  line [in] The zero based line.
+    *
+    *   \remarks
+    *       This is where the new line is, or the carriage return before it. The last line ends at
+    *       the end of the string.
+    */
+    size_t lineend(size_t line) const
+    {
+        assert(line < this->lineStarts.size());
+
+        if (line + 1 == this->lineStarts.size())
+        {
+            return this->strLength;
+        }
+
+        size_t end = this->lineStarts[line + 1] - 1;
+        if (end > this->lineStarts[line] && this->str[end - 1] == '\r')
+        {
+            end -= 1;
+        }
+
+        return end;
+    }
+
+    /**
+    *   \brief            Retrieves the specified line, without the new line at the end. This is the same line nextline() would return.
+    *   \param  line [in] The zero based line.
+    *
+    *   \remarks
+    *       Any line can be jumped to in constant time. To process the lines on several threads,
+    *       give each thread a range of line numbers.
+    */
+    reference_string<const T> linetext(size_t line) const
+    {
+        reference_string<const T> result;
+        result.start = this->str + this->linestart(line);
+        result.end   = this->str + this->lineend(line);
+
+        return result;
+    }
+
+    /**
+    *   \brief              Retrieves the line that the specified offset is on.
+    *   \param  offset [in] The offset in T's. This can be equal to the length of the string.
+    */
+    size_t line(size_t offset) const
+    {
+        assert(!this->lineStarts.empty());
+        assert(offset <= this->strLength);
+
+        // The last line starting at or before the offset.
+        return (size_t)(std::upper_bound(this->lineStarts.begin(), this->lineStarts.end(), offset) - this->lineStarts.begin()) - 1;
+    }
+
+    /**
+    *   \brief              Retrieves the line and column of the specified offset.
+    *   \param  offset [in] The offset in T's. This can be equal to the length of the string.
+    *
+    *   \remarks
+    *       The line is found in O(log n). The column in characters requires the start of the line
+    *       to be scanned, the column in T's does not.
+    */
+    TEXT_POSITION position(size_t offset) const
+    {
+        TEXT_POSITION result;
+        result.offset      = offset;
+        result.line        = this->line(offset);
+        result.columnUnits = offset - this->lineStarts[result.line];
+        result.column      = _countchars(this->str + this->lineStarts[result.line], this->str + offset);
+
+        return result;
+    }
+
+
+private:
+
+    // Adds the offset of the start of each line after a new line.
+    struct _line_start_collector
+    {
+        const T *str;
+        std::vector<size_t> *lineStarts;
+
+        void operator()(const T *new_line)
+        {
+            this->lineStarts->push_back((size_t)(new_line + 1 - this->str));
+        }
+    };
+
+    // Adds the start of each line that starts in (start, end] to 'lineStarts', as offsets from 'str'.
+    static void _indexlines(const T *str, const T *start, const T *end, std::vector<size_t> *lineStarts)
+    {
+        _line_start_collector collector;
+        collector.str = str;
+        collector.lineStarts = lineStarts;
+
+        _foreachnewline(start, end, collector);
+    }
+
+
+    /// The string that was indexed.
+    const T *str;
+
+    /// The length in T's of the indexed string.
+    size_t strLength;
+
+    /// The offset of the start of each line. There's always at least one.
+    std::vector<size_t> lineStarts;
+};
+
+
+/**
+*   \brief                 Counts the lines in a string.
+*   \param  str       [in] The string.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*
+*   \remarks
+*       This is the same as line_index::linecount(), without building the index. The new lines are
+*       counted 64 bytes at a time.
+*/
+template <typename T>
+inline size_t countlines(const T *str, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    return _countnewlines(str, str + strLength) + 1;
+}
+
+}
+
+#endif // DRSL_LINEINDEX
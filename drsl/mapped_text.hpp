@@ -0,0 +1,312 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_MAPPED_TEXT
+#define DRSL_MAPPED_TEXT
+
+#if (PLATFORM == PLATFORM_LINUX) || (PLATFORM == PLATFORM_OSX)
+#define DRSL_MAPPED_TEXT_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace drsl
+{
+
+/**
+*   \brief  Class for looking at the contents of a file as a string, without copying it.
+*
+*   On Linux and OS X the file is mapped into memory with mmap(), so opening it takes the same
+*   time no matter how big it is, and each page is only read from disk when the string gets to
+*   it. Files that can't be mapped, such as pipes and the files in /proc, are read into memory
+*   with read() instead. On other platforms every file is read with fread().
+*
+*   The contents are treated as code units of type T in the machine's byte order, and a BOM at
+*   the start is skipped. Bytes at the end that don't make up a whole T are ignored.
+*
+*   The text is read-only and is not null terminated, so its length has to be given to whatever
+*   it's used with. For example:
+*
+*       mapped_text<char> file("server.log");
+*       reference_string<const char> text = file.text();
+*
+*       const char *str = text.start;
+*       reference_string<const char> line;
+*       while (nextline(line, str, text.end))
+*       {
+*           ...
+*       }
+*
+*   The same goes for split(), extracttokens() and line_index, which all take a length. Every
+*   string they return points into the mapping, so nothing is copied at any point.
+*
+*   The text stays valid until the file is closed or this object is destroyed. Changing the size
+*   of a file while it's mapped is not supported.
+*/
+template <typename T>
+class mapped_text
+{
+public:
+
+    /**
+    *   \brief  Default constructor. Nothing is open until open() is called.
+    */
+    mapped_text()
+        : mapping(NULL), mappingSize(0), buffer(), textStart(NULL), textEnd(NULL), bom(0), opened(false)
+    {
+    }
+
+    /**
+    *   \brief                Constructor.
+    *   \param  fileName [in] The name of the file to open. Use isopen() to check whether or not it worked.
+    */
+    explicit mapped_text(const char *fileName)
+        : mapping(NULL), mappingSize(0), buffer(), textStart(NULL), textEnd(NULL), bom(0), opened(false)
+    {
+        this->open(fileName);
+    }
+
+    /**
+    *   \brief  Destructor.
+    */
+    ~mapped_text()
+    {
+        this->close();
+    }
+
+
+    /**
+    *   \brief                Opens a file, closing the one that's already open.
+    *   \param  fileName [in] The name of the file to open.
+    *   \return               True if the file was opened; false otherwise.
+    *
+    *   \remarks
+    *       An empty file is opened successfully, and gives an empty string.
+    */
+    bool open(const char *fileName)
+    {
+        assert(fileName != NULL);
+
+        this->close();
+
+#ifdef DRSL_MAPPED_TEXT_MMAP
+        int file = ::open(fileName, O_RDONLY);
+        if (file == -1)
+        {
+            return false;
+        }
+
+        // Only regular files can be mapped. An empty file can't be, but there's nothing to read anyway.
+        struct stat info;
+        if (fstat(file, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && (unsigned long long)info.st_size <= (size_t)-1)
+        {
+            void *mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping != MAP_FAILED)
+            {
+                this->mapping     = mapping;
+                this->mappingSize = (size_t)info.st_size;
+                this->_settext((const T *)mapping, this->mappingSize);
+                this->opened      = true;
+            }
+        }
+
+        if (!this->opened)
+        {
+            this->opened = this->_readall(file);
+        }
+
+        ::close(file);
+#else
+        FILE *file = fopen(fileName, "rb");
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        this->opened = this->_readall(file);
+
+        fclose(file);
+#endif
+
+        return this->opened;
+    }
+
+    /**
+    *   \brief  Closes the file. The text can not be used after this.
+    */
+    void close()
+    {
+#ifdef DRSL_MAPPED_TEXT_MMAP
+        if (this->mapping != NULL)
+        {
+            munmap(this->mapping, this->mappingSize);
+        }
+#endif
+
+        this->mapping     = NULL;
+        this->mappingSize = 0;
+        this->textStart   = NULL;
+        this->textEnd     = NULL;
+        this->bom         = 0;
+        this->opened      = false;
+
+        std::vector<T>().swap(this->buffer);
+    }
+
+
+    /**
+    *   \brief  Determines whether or not a file is open.
+    */
+    bool isopen() const
+    {
+        return this->opened;
+    }
+
+    /**
+    *   \brief  Determines whether or not the file is mapped. This is false if it had to be read into memory.
+    */
+    bool ismapped() const
+    {
+        return this->mapping != NULL;
+    }
+
+    /**
+    *   \brief  Determines whether or not the file started with a BOM, which has been skipped.
+    */
+    bool hasbom() const
+    {
+        return this->bom != 0;
+    }
+
+
+    /**
+    *   \brief  Retrieves the contents of the file after the BOM.
+    */
+    reference_string<const T> text() const
+    {
+        reference_string<const T> result;
+        result.start = this->textStart;
+        result.end   = this->textEnd;
+
+        return result;
+    }
+
+    /**
+    *   \brief  Retrieves a pointer to the start of the contents of the file after the BOM. This is NULL for an empty file.
+    */
+    const T * data() const
+    {
+        return this->textStart;
+    }
+
+    /**
+    *   \brief  Retrieves the size in T's of the contents of the file after the BOM.
+    */
+    size_t size() const
+    {
+        return (size_t)(this->textEnd - this->textStart);
+    }
+
+
+
+private:
+
+    // Not copyable, since the mapping is owned.
+    mapped_text(const mapped_text &);
+    mapped_text & operator=(const mapped_text &);
+
+
+#ifdef DRSL_MAPPED_TEXT_MMAP
+    typedef int _file_handle;
+
+    // Reads up to 'size' bytes. Returns the number read, 0 at the end of the file or -1 on error.
+    static ptrdiff_t _readsome(int file, void *dest, size_t size)
+    {
+        ssize_t bytes_read;
+        do
+        {
+            bytes_read = ::read(file, dest, size);
+        } while (bytes_read == -1 && errno == EINTR);
+
+        return (ptrdiff_t)bytes_read;
+    }
+#else
+    typedef FILE * _file_handle;
+
+    static ptrdiff_t _readsome(FILE *file, void *dest, size_t size)
+    {
+        size_t bytes_read = fread(dest, 1, size, file);
+        if (bytes_read == 0 && ferror(file))
+        {
+            return -1;
+        }
+
+        return (ptrdiff_t)bytes_read;
+    }
+#endif
+
+    // Reads the rest of the file into 'buffer'. The buffer is doubled in size as it fills up, since
+    // the size of the file isn't always known up front.
+    bool _readall(_file_handle file)
+    {
+        size_t byte_count = 0;
+        for ( ; ; )
+        {
+            if (byte_count == this->buffer.size() * sizeof(T))
+            {
+                this->buffer.resize(this->buffer.empty() ? 65536 / sizeof(T) : this->buffer.size() * 2);
+            }
+
+            ptrdiff_t bytes_read = _readsome(file, (char *)&this->buffer[0] + byte_count, this->buffer.size() * sizeof(T) - byte_count);
+            if (bytes_read < 0)
+            {
+                std::vector<T>().swap(this->buffer);
+                return false;
+            }
+
+            if (bytes_read == 0)
+            {
+                break;
+            }
+
+            byte_count += (size_t)bytes_read;
+        }
+
+        this->buffer.resize(byte_count / sizeof(T));
+        this->_settext(this->buffer.empty() ? NULL : &this->buffer[0], byte_count);
+
+        return true;
+    }
+
+    void _settext(const T *start, size_t byteCount)
+    {
+        this->textStart = start;
+        this->textEnd   = start + byteCount / sizeof(T);
+        this->bom       = skipbom(this->textStart, this->textEnd);
+    }
+
+
+    /// The address of the mapping, or NULL if the file was read into 'buffer' instead.
+    void *mapping;
+
+    /// The size in bytes of the mapping.
+    size_t mappingSize;
+
+    /// The contents of the file when it couldn't be mapped.
+    std::vector<T> buffer;
+
+    /// The text, after the BOM.
+    const T *textStart;
+    const T *textEnd;
+
+    /// The BOM that was skipped, or 0.
+    char32_t bom;
+
+    /// Whether or not a file is open.
+    bool opened;
+};
+
+}
+
+#endif // DRSL_MAPPED_TEXT
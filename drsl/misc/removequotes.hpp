@@ -72,6 +72,184 @@ void removequotes(T *str, const T *quotes, char32_t escape = '\\', size_t strLen
     }
 }
 
+
+// Finds the next quote or escape character at or after 'str', and sets 'ch' to which one it is.
+// Returns 'end' if there are none. An escape character of 0 means there is none.
+template <typename T>
+const T * _findquotestop(const T *str, const T *end, char32_t quoteCharacter, char32_t escape, char32_t &ch)
+{
+    if (quoteCharacter < 0x80 && escape < 0x80)
+    {
+        // Neither can be part of a multi-unit character, so the code units can be searched directly.
+        str = _findeither(str, end, (T)quoteCharacter, (escape != '\0') ? (T)escape : (T)quoteCharacter);
+        if (str < end)
+        {
+            ch = (*str == (T)quoteCharacter) ? quoteCharacter : escape;
+        }
+
+        return str;
+    }
+
+    while (str < end)
+    {
+        const T *next = str;
+        ch = nextchar(next);
+        if (ch == '\0')
+        {
+            // A null terminator or an invalid character ends the quote, the same as when tokenising.
+            return end;
+        }
+
+        if (ch == quoteCharacter || (ch == escape && escape != '\0'))
+        {
+            return str;
+        }
+
+        str = next;
+    }
+
+    return end;
+}
+
+// Scans the inside of a quote, moving 'str' to the closing quote, or to 'end' if there isn't one.
+// 'str' starts just past the opening quote. If 'buffer' isn't NULL, the text is copied to it with
+// the escape character taken out from in front of each escaped quote, and 'buffer' is moved to the
+// end of the copy. If 'stopAtEscape' is set, the scan instead stops with 'str' on the first escape
+// character that's in front of a quote, and returns false.
+template <typename T>
+bool _scanquoted(const T *&str, const T *end, char32_t quoteCharacter, char32_t escape, T *&buffer, bool stopAtEscape)
+{
+    const size_t escape_width = charwidth<T>(escape);
+
+    for ( ; ; )
+    {
+        char32_t ch = '\0';
+        const T *stop = _findquotestop(str, end, quoteCharacter, escape, ch);
+
+        if (buffer != NULL)
+        {
+            memcpy(buffer, str, (size_t)(stop - str) * sizeof(T));
+            buffer += stop - str;
+        }
+
+        str = stop;
+        if (stop == end || ch == quoteCharacter)
+        {
+            return true;
+        }
+
+        // An escape character, which only means something when it's in front of a quote.
+        const T *quote = stop + escape_width;
+        const T *after = quote;
+        if (quote < end && nextchar(after) == quoteCharacter)
+        {
+            if (stopAtEscape)
+            {
+                return false;
+            }
+
+            if (buffer != NULL)
+            {
+                memcpy(buffer, quote, (size_t)(after - quote) * sizeof(T));
+                buffer += after - quote;
+            }
+
+            str = after;
+        }
+        else
+        {
+            if (buffer != NULL)
+            {
+                memcpy(buffer, stop, escape_width * sizeof(T));
+                buffer += escape_width;
+            }
+
+            str = quote;
+        }
+    }
+}
+
+
+/**
+*   \brief                  Retrieves the text inside the quotation marks at the start of a string, without modifying the string.
+*   \param  str        [in]  The string starting with the quote.
+*   \param  quotes     [in]  The string containing the different quote characters to consider quotes.
+*   \param  buffer     [out] The buffer that receives the text when it has escaped quotes. This needs room for \c strLength T's. Can be NULL.
+*   \param  escape     [in]  The escape character, or 0 if there isn't one.
+*   \param  strLength  [in]  The length in T's of the input string, not including the null terminator.
+*   \return                  The text inside the quotation marks.
+*
+*   \remarks
+*       The quote ends at the next matching quote character that is not prefixed with the escape
+*       character, the same as removequotes() and the tokenisers. A quote without an end runs to
+*       the end of the string, and a string that doesn't start with a quote is returned as is.
+*       \par
+*       When there are no escaped quotes, which is the usual case, the returned string points into
+*       \c str and nothing is copied. Otherwise the text is copied to \c buffer in a single pass,
+*       with the escape character taken out from in front of each escaped quote, and the returned
+*       string points into \c buffer, which is also null terminated. Escape characters that aren't
+*       in front of a quote are left alone. If \c buffer is NULL, the text always points into
+*       \c str, with any escape characters left in.
+*       \par
+*       This works on the tokens from nexttoken() and the tokenisers, which include their quotes,
+*       so quoted tokens can be used without touching the buffer they were found in:
+*
+*           std::vector<char> buffer(length(token) + 1);
+*           reference_string<const char> value = unquote(token, "\"'", &buffer[0]);
+*/
+template <typename T>
+reference_string<const T> unquote(const T *str, const T *quotes, T *buffer, char32_t escape = '\\', size_t strLength = -1)
+{
+    assert(str != NULL);
+    assert(quotes != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    const T *end = str + strLength;
+
+    reference_string<const T> result;
+    result.start = str;
+    result.end   = end;
+
+    const T *temp = str;
+    char32_t quote_ch = (strLength > 0) ? nextchar(temp) : '\0';
+    if (quote_ch == '\0' || findfirstof(quotes, quote_ch) == NULL)
+    {
+        return result;
+    }
+
+    result.start = temp;
+
+    // Look for the end of the quote first, in case there's nothing to unescape. Only then does
+    // anything need copying, starting with the text before the first escaped quote.
+    T *buffer_end = NULL;
+    if (_scanquoted(temp, end, quote_ch, escape, buffer_end, buffer != NULL))
+    {
+        result.end = temp;
+        return result;
+    }
+
+    buffer_end = buffer + (temp - result.start);
+    memcpy(buffer, result.start, (size_t)(temp - result.start) * sizeof(T));
+
+    _scanquoted(temp, end, quote_ch, escape, buffer_end, false);
+    *buffer_end = '\0';
+
+    result.start = buffer;
+    result.end   = buffer_end;
+
+    return result;
+}
+
+template <typename T>
+reference_string<const T> unquote(const reference_string<T> &str, const T *quotes, T *buffer, char32_t escape = '\\')
+{
+    return unquote((const T *)str.start, quotes, buffer, escape, length(str));
+}
+
 }
 
 #endif // DRSL_MISC_REMOVEQUOTES
@@ -0,0 +1,480 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+//
+// Replaces any number of substrings in one pass. The patterns are compiled into a trie, and the
+// text is scanned for the code units that can start a pattern. Where one can, the trie is walked
+// to find the longest pattern starting there. When every pattern is a single ASCII code unit,
+// which covers escaping things like & < > " ', the trie is replaced with a translation table.
+
+#ifndef DRSL_MULTI_REPLACER
+#define DRSL_MULTI_REPLACER
+
+namespace drsl
+{
+
+template <typename T>
+class multi_replacer
+{
+public:
+
+    /**
+    *   \brief  Default constructor. Nothing is replaced until build() is called.
+    */
+    multi_replacer()
+    {
+        this->build(NULL, NULL, 0);
+    }
+
+    /**
+    *   \brief             Constructor.
+    *   \param  from  [in] The substrings to replace.
+    *   \param  to    [in] The string to replace each substring with.
+    *   \param  count [in] The number of items in \c from and \c to.
+    */
+    multi_replacer(const T *const *from, const T *const *to, size_t count)
+    {
+        this->build(from, to, count);
+    }
+
+
+    /**
+    *   \brief             Compiles a set of replacements, replacing the existing ones.
+    *   \param  from  [in] The null terminated substrings to replace.
+    *   \param  to    [in] The null terminated string to replace each substring with.
+    *   \param  count [in] The number of items in \c from and \c to.
+    *
+    *   \remarks
+    *       The strings are copied, so they don't need to stay around after this returns.
+    *       \par
+    *       Empty substrings are ignored. If a substring is given more than once, the first
+    *       replacement is used.
+    */
+    void build(const T *const *from, const T *const *to, size_t count)
+    {
+        this->storage.clear();
+        this->replacements.clear();
+        this->nodes.clear();
+        this->edgeUnits.clear();
+        this->edgeTargets.clear();
+        this->maxGrowth = 0;
+        this->skipCount = 0;
+        this->useUnitTable = false;
+        memset(this->startFilter, 0, sizeof(this->startFilter));
+
+        // Build the trie with a list of children per node first, then flatten it.
+        std::vector<std::vector<std::pair<T, uint32_t> > > children(1);
+        std::vector<int> terminals(1, -1);
+
+        for (size_t iPattern = 0; iPattern < count; ++iPattern)
+        {
+            assert(from[iPattern] != NULL);
+            assert(to[iPattern] != NULL);
+
+            size_t from_length = length(from[iPattern]);
+            if (from_length == 0)
+            {
+                continue;
+            }
+
+            uint32_t node = 0;
+            for (size_t i = 0; i < from_length; ++i)
+            {
+                T unit = from[iPattern][i];
+
+                size_t iChild = 0;
+                while (iChild < children[node].size() && children[node][iChild].first != unit)
+                {
+                    ++iChild;
+                }
+
+                if (iChild == children[node].size())
+                {
+                    children[node].push_back(std::make_pair(unit, (uint32_t)children.size()));
+                    children.push_back(std::vector<std::pair<T, uint32_t> >());
+                    terminals.push_back(-1);
+                }
+
+                node = children[node][iChild].second;
+            }
+
+            if (terminals[node] != -1)
+            {
+                continue;
+            }
+
+            _replacement replacement;
+            replacement.offset = this->storage.size();
+            replacement.length = length(to[iPattern]);
+            this->storage.insert(this->storage.end(), to[iPattern], to[iPattern] + replacement.length);
+
+            terminals[node] = (int)this->replacements.size();
+            this->replacements.push_back(replacement);
+
+            if (replacement.length > from_length && replacement.length - from_length > this->maxGrowth)
+            {
+                this->maxGrowth = replacement.length - from_length;
+            }
+        }
+
+        for (size_t iNode = 0; iNode < children.size(); ++iNode)
+        {
+            std::sort(children[iNode].begin(), children[iNode].end());
+
+            _node node;
+            node.firstEdge   = (uint32_t)this->edgeUnits.size();
+            node.edgeCount   = (uint32_t)children[iNode].size();
+            node.replacement = terminals[iNode];
+            this->nodes.push_back(node);
+
+            for (size_t iChild = 0; iChild < children[iNode].size(); ++iChild)
+            {
+                this->edgeUnits.push_back(children[iNode][iChild].first);
+                this->edgeTargets.push_back(children[iNode][iChild].second);
+            }
+        }
+
+
+        // The code units that can start a pattern are the root's edges. A small set is searched for
+        // directly, otherwise a filter on the low byte is used.
+        const std::vector<std::pair<T, uint32_t> > &roots = children[0];
+        if (roots.size() <= 8)
+        {
+            this->skipCount = roots.size();
+            for (size_t i = 0; i < roots.size(); ++i)
+            {
+                this->skipUnits[i] = roots[i].first;
+            }
+        }
+
+        for (size_t i = 0; i < roots.size(); ++i)
+        {
+            this->startFilter[_codeunit(roots[i].first) & 0xFF] = true;
+        }
+
+        // If every pattern is a single ASCII code unit, the trie is never needed.
+        this->useUnitTable = !roots.empty();
+        for (size_t i = 0; i < 128; ++i)
+        {
+            this->unitTable[i] = -1;
+        }
+
+        for (size_t i = 0; i < roots.size() && this->useUnitTable; ++i)
+        {
+            char32_t unit = _codeunit(roots[i].first);
+            const _node &node = this->nodes[roots[i].second];
+
+            this->useUnitTable = unit < 128 && node.edgeCount == 0;
+            if (this->useUnitTable)
+            {
+                this->unitTable[unit] = node.replacement;
+            }
+        }
+    }
+
+
+    /**
+    *   \brief                 Retrieves the size of the buffer needed to store the string with every replacement made.
+    *   \param  str       [in] The string the replacements are made in.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    *   \return                The number of T's needed, including the null terminator.
+    */
+    size_t replacesize(const T *str, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = length(str);
+        }
+
+        return this->_run(NULL, str, str + strLength) + 1;
+    }
+
+    size_t replacesize(const reference_string<T> &str) const
+    {
+        return this->replacesize(str.start, length(str));
+    }
+
+
+    /**
+    *   \brief                  Copies a string with every replacement made.
+    *   \param  dest      [out] The buffer that will recieve the new string. Can be NULL, in which case nothing is written.
+    *   \param  str       [in]  The string to copy. This must not overlap \c dest.
+    *   \param  destSize  [in]  The size in T's of the buffer pointed to by \c dest.
+    *   \param  strLength [in]  The length in T's of the input string, not including the null terminator.
+    *   \return                 The number of T's that must be allocated in \c dest in order to store the new string.
+    *
+    *   \remarks
+    *       At each position, the longest substring that starts there is replaced, and scanning
+    *       continues after it. Replacements are never scanned again. Substrings are matched code
+    *       unit by code unit, which works for any encoding.
+    *       \par
+    *       If \c destSize is equal to -1, the function will assume that the buffer is large enough, and
+    *       the string is copied in a single pass. Otherwise the size is worked out first, and nothing
+    *       is written if the buffer is too small.
+    */
+    size_t replace(T *dest, const T *str, size_t destSize = -1, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = length(str);
+        }
+
+        if (dest == NULL || destSize != (size_t)-1)
+        {
+            size_t result_size = this->_run(NULL, str, str + strLength) + 1;
+            if (dest == NULL || result_size > destSize)
+            {
+                return result_size;
+            }
+        }
+
+        size_t result_length = this->_run(dest, str, str + strLength);
+        dest[result_length] = '\0';
+
+        return result_length + 1;
+    }
+
+    size_t replace(T *dest, const reference_string<T> &str, size_t destSize = -1) const
+    {
+        return this->replace(dest, str.start, destSize, length(str));
+    }
+
+    /**
+    *   \brief                      Makes every replacement in a string, in place.
+    *   \param  str       [in, out] The string that should have its substrings replaced.
+    *   \param  strSize   [in]      The size in T's of the buffer pointed to by \c str.
+    *   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+    *   \return                     The number of T's that must be allocated in the strings buffer in order to store the modified string.
+    *
+    *   \remarks
+    *       If \c strSize is equal to -1, the function will assume that the buffer is large enough to
+    *       store the modified string. If it's too small, the string is left untouched.
+    *       \par
+    *       When no replacement is longer than its substring, the string is rewritten in a single
+    *       pass. Otherwise the size is worked out first and the string is moved up so the output
+    *       never catches up with the input, the same as replaceall(). If some replacements grow and
+    *       others shrink, the buffer may need to be larger than the result for this. The result is
+    *       null terminated if there is room for it.
+    */
+    size_t replace(T *str, size_t strSize = -1, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = length(str);
+        }
+
+        if (this->maxGrowth == 0)
+        {
+            size_t result_length = this->_run(str, str, str + strLength);
+            if (strSize == (size_t)-1 || result_length < strSize)
+            {
+                str[result_length] = '\0';
+            }
+
+            return result_length + 1;
+        }
+
+        // The string is moved up by as much as the output ever gets ahead of the input. That's at
+        // least as much as the result grows by, but can be more if some replacements grow and later
+        // ones shrink.
+        size_t ahead = 0;
+        size_t result_length = this->_run(NULL, str, str + strLength, &ahead);
+
+        size_t required_size = ((result_length > strLength + ahead) ? result_length : strLength + ahead) + 1;
+        if (strSize != (size_t)-1 && required_size > strSize)
+        {
+            return required_size;
+        }
+
+        if (ahead > 0)
+        {
+            memmove(str + ahead, str, strLength * sizeof(T));
+        }
+
+        this->_run(str, str + ahead, str + ahead + strLength);
+        str[result_length] = '\0';
+
+        return required_size;
+    }
+
+
+
+private:
+
+    /// A node in the trie. Its edges are sorted by code unit.
+    struct _node
+    {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+
+        /// The index of the replacement for the pattern ending at this node, or -1.
+        int replacement;
+    };
+
+    /// A replacement string, stored in 'storage'.
+    struct _replacement
+    {
+        size_t offset;
+        size_t length;
+    };
+
+
+    // Retrieves the next position in [str, end) where a pattern could start.
+    const T * _nextcandidate(const T *str, const T *end) const
+    {
+        if (this->skipCount > 0)
+        {
+            return _findanyof(str, end, this->skipUnits, this->skipCount);
+        }
+
+        while (str < end && !this->startFilter[_codeunit(*str) & 0xFF])
+        {
+            ++str;
+        }
+
+        return str;
+    }
+
+    // Finds the longest pattern starting at 'str'. Returns the index of its replacement, or -1 if
+    // there isn't one.
+    int _longestmatch(const T *str, const T *end, size_t &matchLength) const
+    {
+        int result = -1;
+
+        const _node *node = &this->nodes[0];
+        for (size_t depth = 0; str + depth < end && node->edgeCount > 0; ++depth)
+        {
+            const T *first = &this->edgeUnits[node->firstEdge];
+            const T *last  = first + node->edgeCount;
+
+            const T *edge = std::lower_bound(first, last, str[depth]);
+            if (edge == last || *edge != str[depth])
+            {
+                break;
+            }
+
+            node = &this->nodes[this->edgeTargets[edge - &this->edgeUnits[0]]];
+            if (node->replacement != -1)
+            {
+                result = node->replacement;
+                matchLength = depth + 1;
+            }
+        }
+
+        return result;
+    }
+
+    // Writes [str, end) to 'dest' with every replacement made, or just measures it if 'dest' is NULL.
+    // 'dest' can overlap the input as long as it never gets ahead of it. Returns the length of the
+    // result in T's. 'ahead' receives the most T's the output gets ahead of the input by.
+    size_t _run(T *dest, const T *str, const T *end, size_t *ahead = NULL) const
+    {
+        const T *start = str;
+
+        if (this->replacements.empty())
+        {
+            if (dest != NULL)
+            {
+                memmove(dest, str, (size_t)(end - str) * sizeof(T));
+            }
+
+            return (size_t)(end - str);
+        }
+
+        size_t result = 0;
+        for (;;)
+        {
+            const T *candidate = this->_nextcandidate(str, end);
+            if (dest != NULL)
+            {
+                memmove(dest + result, str, (size_t)(candidate - str) * sizeof(T));
+            }
+
+            result += (size_t)(candidate - str);
+            str = candidate;
+
+            if (str == end)
+            {
+                break;
+            }
+
+            int index = -1;
+            size_t match_length = 1;
+            if (this->useUnitTable)
+            {
+                // The start filter only looks at the low byte, so wide units can get this far.
+                char32_t unit = _codeunit(*str);
+                if (unit < 128)
+                {
+                    index = this->unitTable[unit];
+                }
+            }
+            else
+            {
+                index = this->_longestmatch(str, end, match_length);
+            }
+
+            if (index == -1)
+            {
+                if (dest != NULL)
+                {
+                    dest[result] = *str;
+                }
+
+                result += 1;
+                str += 1;
+                continue;
+            }
+
+            const _replacement &replacement = this->replacements[index];
+            if (dest != NULL && replacement.length > 0)
+            {
+                memcpy(dest + result, &this->storage[replacement.offset], replacement.length * sizeof(T));
+            }
+
+            result += replacement.length;
+            str += match_length;
+
+            if (ahead != NULL && result > (size_t)(str - start) && result - (size_t)(str - start) > *ahead)
+            {
+                *ahead = result - (size_t)(str - start);
+            }
+        }
+
+        return result;
+    }
+
+
+    /// The characters of every replacement string.
+    std::vector<T> storage;
+
+    /// The replacement strings.
+    std::vector<_replacement> replacements;
+
+    /// The trie. The root is the first node.
+    std::vector<_node> nodes;
+    std::vector<T> edgeUnits;
+    std::vector<uint32_t> edgeTargets;
+
+    /// The most T's any one replacement adds.
+    size_t maxGrowth;
+
+    /// The code units that can start a pattern, when there are no more than 8 of them.
+    T skipUnits[8];
+    size_t skipCount;
+
+    /// Whether or not a pattern can start with a code unit, indexed by its low byte.
+    bool startFilter[256];
+
+    /// When every pattern is a single ASCII code unit, the replacement for each unit or -1.
+    bool useUnitTable;
+    int unitTable[128];
+};
+
+}
+
+#endif // DRSL_MULTI_REPLACER
@@ -16,10 +16,13 @@ namespace drsl
 *       When this function returns a non-null value, the \c start elements of \c line is always set to \c str.
 *       \par
 *       The input string must be null terminated. The only time this function will return false is when the
-*       string has no characters other than a null terminator. If this behaviour is not desireable, the
-*       application will need to manually determine when nextline() should stop being called.
+*       string has no characters other than a null terminator. If this behaviour is not desireable, use
+*       the overload below which takes the end of the string.
 *       \par
-*       The returned string will not contain the new-line delimiter.
+*       The returned string will not contain the new-line delimiter. A carriage return on its own does not
+*       end a line.
+*       \par
+*       The string is scanned 16 bytes at a time for the next new line or null terminator.
 */
 template <typename T>
 inline bool nextline(reference_string<T> &line, T *&str)
@@ -33,39 +36,60 @@ inline bool nextline(reference_string<T> &line, T *&str)
 
     line.start = str;
 
-    // We need to loop through each character in the string and look for a carriage return
-    // and new line character.
-    T *temp = str;
-    char32_t ch;
-    while ((ch = nextchar(temp)) != '\0')
+    // Both "\r\n" and "\n" end a line, so only new lines need looking for. Neither a new line nor a
+    // carriage return can be part of a longer character, so there's no need to decode anything.
+    T *new_line = str + (_skiptolineend((const T *)str, (const T *)NULL) - str);
+    if (*new_line == '\0')
+    {
+        // If we've made it here, we're at the end of the string. Therefore, we want to end this
+        // line and return.
+        line.end = new_line;
+        str = new_line;
+
+        return true;
+    }
+
+    line.end = (new_line > line.start && new_line[-1] == '\r') ? new_line - 1 : new_line;
+    str = new_line + 1;
+
+    return true;
+}
+
+/**
+*   \brief             Retrieves the line that the specified string is positioned at and moves to the next one, stopping at the given end.
+*   \param  line [out] The reference string that will recieve the line.
+*   \param  str  [in]  The string to retrieve the line from.
+*   \param  end  [in]  The end of the string.
+*   \return            True if a line was retrieved; false if \c str is at \c end.
+*
+*   \remarks
+*       This is the same as nextline() above, except that the string does not need to be null
+*       terminated, and null terminators are treated like any other character. Use this to walk
+*       the lines of part of a buffer, such as the range between two line starts of a line_index.
+*/
+template <typename T>
+inline bool nextline(reference_string<T> &line, T *&str, T *end)
+{
+    assert(str != NULL);
+
+    if (str >= end)
+    {
+        return false;
+    }
+
+    line.start = str;
+
+    T *new_line = str + (_findeither((const T *)str, (const T *)end, (T)'\n', (T)'\n') - str);
+    if (new_line == end)
     {
-        // We need to check for both "\r\n" and "\n" lines.
-        if (ch == '\r')
-        {
-            // We will grab the next character. If this is equal to '\n', we have a new line.
-            T *temp2 = temp;
-            if (nextchar(temp2) == '\n')
-            {
-                // We have a new line. We will set the line and return.
-                line.end = str;
-                str = temp2;
-                return true;
-            }
-        }
-        else if (ch == '\n')
-        {
-            // We have a new line.
-            line.end = str;
-            str = temp;
-            return true;
-        }
-
-        str = temp;
+        line.end = new_line;
+        str = new_line;
+
+        return true;
     }
 
-    // If we've made it here, we're at the end of the string. Therefore, we
-    // want to end this line and return.
-    line.end = str;
+    line.end = (new_line > line.start && new_line[-1] == '\r') ? new_line - 1 : new_line;
+    str = new_line + 1;
 
     return true;
 }
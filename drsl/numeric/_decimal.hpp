@@ -0,0 +1,355 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+//
+// Exact decimal to binary floating point conversion. This is the slow path used by tryparse()
+// when a number can not be converted exactly with a single floating point operation. The
+// decimal is stored as a string of digits which is repeatedly shifted by powers of two until
+// it's in the range [1, 2), at which point the mantissa bits can be read off and correctly
+// rounded. It's slow, but it's exact, uses no tables and does not depend on the C library.
+
+#ifndef DRSL_NUMERIC_DECIMAL
+#define DRSL_NUMERIC_DECIMAL
+
+namespace drsl
+{
+
+#define DRSL_DECIMAL_MAX_DIGITS     800
+
+/**
+*   \brief  A decimal value equal to 0.digits * 10^point.
+*/
+struct _decimal
+{
+    /// The digits, as values 0-9, most significant first.
+    unsigned char digits[DRSL_DECIMAL_MAX_DIGITS];
+
+    /// The number of digits in use.
+    int count;
+
+    /// The position of the decimal point relative to the first digit.
+    int point;
+
+    /// Whether or not non-zero digits were discarded past the end of the digit buffer.
+    bool truncated;
+};
+
+
+inline void _decimal_init(_decimal &d)
+{
+    d.count = 0;
+    d.point = 0;
+    d.truncated = false;
+}
+
+/**
+*   \brief  Appends a digit to the decimal. Leading zeros must be handled by the caller.
+*/
+inline void _decimal_pushdigit(_decimal &d, unsigned int digit)
+{
+    if (d.count < DRSL_DECIMAL_MAX_DIGITS)
+    {
+        d.digits[d.count++] = (unsigned char)digit;
+    }
+    else if (digit != 0)
+    {
+        d.truncated = true;
+    }
+}
+
+inline void _decimal_trim(_decimal &d)
+{
+    while (d.count > 0 && d.digits[d.count - 1] == 0)
+    {
+        --d.count;
+    }
+
+    if (d.count == 0)
+    {
+        d.point = 0;
+    }
+}
+
+// Divides the decimal by 2^shift. shift must be no more than 60.
+inline void _decimal_rightshift(_decimal &d, unsigned int shift)
+{
+    int read  = 0;
+    int write = 0;
+    uint64_t n = 0;
+
+    // Pick up enough leading digits to produce the first output digit.
+    for ( ; (n >> shift) == 0; ++read)
+    {
+        if (read >= d.count)
+        {
+            if (n == 0)
+            {
+                d.count = 0;
+                return;
+            }
+
+            while ((n >> shift) == 0)
+            {
+                n = n * 10;
+                ++read;
+            }
+
+            break;
+        }
+
+        n = n * 10 + d.digits[read];
+    }
+
+    d.point -= read - 1;
+
+    uint64_t mask = (1ULL << shift) - 1;
+    for ( ; read < d.count; ++read)
+    {
+        unsigned int digit = (unsigned int)(n >> shift);
+        n &= mask;
+        d.digits[write++] = (unsigned char)digit;
+        n = n * 10 + d.digits[read];
+    }
+
+    // Put down any extra digits.
+    while (n > 0)
+    {
+        unsigned int digit = (unsigned int)(n >> shift);
+        n &= mask;
+
+        if (write < DRSL_DECIMAL_MAX_DIGITS)
+        {
+            d.digits[write++] = (unsigned char)digit;
+        }
+        else if (digit > 0)
+        {
+            d.truncated = true;
+        }
+
+        n = n * 10;
+    }
+
+    d.count = write;
+    _decimal_trim(d);
+}
+
+// Multiplies the decimal by 2^shift. shift must be no more than 60.
+inline void _decimal_leftshift(_decimal &d, unsigned int shift)
+{
+    // The result can have up to 19 more digits than the input. The new digits are produced
+    // from the least significant end, so they are built backwards in a temporary buffer.
+    unsigned char temp[DRSL_DECIMAL_MAX_DIGITS + 20];
+    int write = (int)sizeof(temp);
+
+    uint64_t n = 0;
+    for (int read = d.count - 1; read >= 0; --read)
+    {
+        n += (uint64_t)d.digits[read] << shift;
+
+        uint64_t quotient = n / 10;
+        temp[--write] = (unsigned char)(n - 10 * quotient);
+        n = quotient;
+    }
+
+    while (n > 0)
+    {
+        uint64_t quotient = n / 10;
+        temp[--write] = (unsigned char)(n - 10 * quotient);
+        n = quotient;
+    }
+
+    int new_count = (int)sizeof(temp) - write;
+    int kept_count = (new_count < DRSL_DECIMAL_MAX_DIGITS) ? new_count : DRSL_DECIMAL_MAX_DIGITS;
+
+    for (int i = kept_count; i < new_count; ++i)
+    {
+        if (temp[write + i] != 0)
+        {
+            d.truncated = true;
+        }
+    }
+
+    memcpy(d.digits, temp + write, (size_t)kept_count);
+
+    d.point += new_count - d.count;
+    d.count = kept_count;
+    _decimal_trim(d);
+}
+
+inline void _decimal_shift(_decimal &d, int shift)
+{
+    if (d.count == 0)
+    {
+        return;
+    }
+
+    while (shift > 60)
+    {
+        _decimal_leftshift(d, 60);
+        shift -= 60;
+    }
+
+    while (shift < -60)
+    {
+        _decimal_rightshift(d, 60);
+        shift += 60;
+    }
+
+    if (shift > 0)
+    {
+        _decimal_leftshift(d, (unsigned int)shift);
+    }
+    else if (shift < 0)
+    {
+        _decimal_rightshift(d, (unsigned int)-shift);
+    }
+}
+
+// Determines whether the decimal should be rounded up when truncated to 'digitCount' digits.
+inline bool _decimal_shouldroundup(const _decimal &d, int digitCount)
+{
+    if (digitCount < 0 || digitCount >= d.count)
+    {
+        return false;
+    }
+
+    // Exactly half way rounds to even.
+    if (d.digits[digitCount] == 5 && digitCount + 1 == d.count)
+    {
+        if (d.truncated)
+        {
+            return true;
+        }
+
+        return digitCount > 0 && (d.digits[digitCount - 1] % 2) == 1;
+    }
+
+    return d.digits[digitCount] >= 5;
+}
+
+// Retrieves the integer part of the decimal, rounded to nearest.
+inline uint64_t _decimal_roundedinteger(const _decimal &d)
+{
+    if (d.point > 20)
+    {
+        return ~0ULL;
+    }
+
+    uint64_t n = 0;
+    int i = 0;
+    for ( ; i < d.point && i < d.count; ++i)
+    {
+        n = n * 10 + d.digits[i];
+    }
+
+    for ( ; i < d.point; ++i)
+    {
+        n *= 10;
+    }
+
+    if (_decimal_shouldroundup(d, d.point))
+    {
+        ++n;
+    }
+
+    return n;
+}
+
+
+/**
+*   \brief                       Converts a decimal to the bits of a binary floating point value.
+*   \param  d             [in]   The decimal to convert. This is modified by the conversion.
+*   \param  mantissaBits  [in]   The number of explicit mantissa bits of the target format (52 or 23).
+*   \param  exponentBits  [in]   The number of exponent bits of the target format (11 or 8).
+*   \param  overflow      [out]  Set to true if the value is too large for the format.
+*   \return                      The bits of the value, without the sign.
+*
+*   \remarks
+*       The result is correctly rounded (round half to even). Values too small for the format
+*       are converted to zero.
+*/
+inline uint64_t _decimal_tofloatbits(_decimal &d, unsigned int mantissaBits, unsigned int exponentBits, bool *overflow)
+{
+    // The number of binary digits that a shift by up to 10^i can be done with without losing
+    // digits below the point.
+    static const int power_table[9] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+
+    int bias = -((1 << (exponentBits - 1)) - 1);
+    int max_exponent = (1 << exponentBits) - 1;
+
+    *overflow = false;
+
+    if (d.count == 0 || d.point < -400)
+    {
+        return 0;
+    }
+
+    if (d.point > 400)
+    {
+        *overflow = true;
+        return (uint64_t)max_exponent << mantissaBits;
+    }
+
+    // Scale by powers of two until the decimal is in [0.5, 1).
+    int exponent = 0;
+    while (d.point > 0)
+    {
+        int n = (d.point >= 9) ? 27 : power_table[d.point];
+        _decimal_shift(d, -n);
+        exponent += n;
+    }
+
+    while (d.point < 0 || (d.point == 0 && d.digits[0] < 5))
+    {
+        int n = (-d.point >= 9) ? 27 : power_table[-d.point];
+        _decimal_shift(d, n);
+        exponent -= n;
+    }
+
+    // Move to [1, 2).
+    exponent -= 1;
+
+    // Denormals have the minimum exponent and an implicit leading zero bit.
+    if (exponent < bias + 1)
+    {
+        int n = bias + 1 - exponent;
+        _decimal_shift(d, -n);
+        exponent += n;
+    }
+
+    if (exponent - bias >= max_exponent)
+    {
+        *overflow = true;
+        return (uint64_t)max_exponent << mantissaBits;
+    }
+
+    // Pull out the mantissa bits, including the implicit leading one.
+    _decimal_shift(d, (int)(1 + mantissaBits));
+    uint64_t mantissa = _decimal_roundedinteger(d);
+
+    // Rounding may have carried into the next power of two.
+    if (mantissa == (2ULL << mantissaBits))
+    {
+        mantissa >>= 1;
+        exponent += 1;
+
+        if (exponent - bias >= max_exponent)
+        {
+            *overflow = true;
+            return (uint64_t)max_exponent << mantissaBits;
+        }
+    }
+
+    // If the leading bit isn't set we have a denormal.
+    if ((mantissa & (1ULL << mantissaBits)) == 0)
+    {
+        exponent = bias;
+    }
+
+    uint64_t bits = mantissa & ((1ULL << mantissaBits) - 1);
+    bits |= (uint64_t)((exponent - bias) & max_exponent) << mantissaBits;
+
+    return bits;
+}
+
+}
+
+#endif // DRSL_NUMERIC_DECIMAL
@@ -0,0 +1,229 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_NUMERIC_PRIVATE
+#define DRSL_NUMERIC_PRIVATE
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace drsl
+{
+
+/*
+ * Every two digit pair from "00" to "99". Indexing with (value * 2) retrieves the two
+ * characters making up the value, which allows numbers to be written two digits at a
+ * time rather than one.
+ */
+static const char g_digitPairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+
+/**
+*   \brief              Multiplies two 64-bit values and returns the full 128-bit product.
+*   \param  a    [in]   The first value.
+*   \param  b    [in]   The second value.
+*   \param  high [out]  Receives the high 64 bits of the product.
+*   \return             The low 64 bits of the product.
+*/
+inline uint64_t _mul128(uint64_t a, uint64_t b, uint64_t *high)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return ::_umul128(a, b, high);
+#else
+    uint64_t a_lo = (uint32_t)a;
+    uint64_t a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b;
+    uint64_t b_hi = b >> 32;
+
+    uint64_t b00 = a_lo * b_lo;
+    uint64_t b01 = a_lo * b_hi;
+    uint64_t b10 = a_hi * b_lo;
+    uint64_t b11 = a_hi * b_hi;
+
+    uint64_t mid1 = b10 + (b00 >> 32);
+    uint64_t mid2 = b01 + (uint32_t)mid1;
+
+    *high = b11 + (mid1 >> 32) + (mid2 >> 32);
+    return (mid2 << 32) | (uint32_t)b00;
+#endif
+}
+
+/**
+*   \brief  Shifts the 128-bit value (high:low) right by 0 < \c shift < 64 bits.
+*/
+inline uint64_t _shiftright128(uint64_t low, uint64_t high, unsigned int shift)
+{
+    assert(shift > 0 && shift < 64);
+
+    return (high << (64 - shift)) | (low >> shift);
+}
+
+
+/**
+*   \brief  Retrieves the number of decimal digits in a value of up to 17 digits.
+*/
+inline unsigned int _decimallength17(uint64_t value)
+{
+    assert(value < 100000000000000000ULL);
+
+    if (value >= 10000000000000000ULL) { return 17; }
+    if (value >= 1000000000000000ULL)  { return 16; }
+    if (value >= 100000000000000ULL)   { return 15; }
+    if (value >= 10000000000000ULL)    { return 14; }
+    if (value >= 1000000000000ULL)     { return 13; }
+    if (value >= 100000000000ULL)      { return 12; }
+    if (value >= 10000000000ULL)       { return 11; }
+    if (value >= 1000000000ULL)        { return 10; }
+    if (value >= 100000000ULL)         { return 9; }
+    if (value >= 10000000ULL)          { return 8; }
+    if (value >= 1000000ULL)           { return 7; }
+    if (value >= 100000ULL)            { return 6; }
+    if (value >= 10000ULL)             { return 5; }
+    if (value >= 1000ULL)              { return 4; }
+    if (value >= 100ULL)               { return 3; }
+    if (value >= 10ULL)                { return 2; }
+
+    return 1;
+}
+
+/**
+*   \brief  Retrieves the number of leading zero bits in a non-zero 64-bit value.
+*/
+inline unsigned int _clz64(uint64_t value)
+{
+    assert(value != 0);
+
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (unsigned int)index;
+#else
+    unsigned int count = 0;
+    while ((value & (1ULL << 63)) == 0)
+    {
+        value <<= 1;
+        ++count;
+    }
+
+    return count;
+#endif
+}
+
+/**
+*   \brief  Retrieves the number of decimal digits required to write a 64-bit value.
+*
+*   \remarks
+*       The digit count is predicted from the bit length of the value (log10(2) is roughly
+*       1233/4096) and then corrected with a single comparison against a power of 10.
+*/
+inline unsigned int _decimallength(uint64_t value)
+{
+    static const uint64_t powers_of_10[20] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+    };
+
+    // Setting the lowest bit never changes the digit count, but makes zero count as one digit.
+    value |= 1;
+
+    unsigned int bits = 64 - _clz64(value);
+    unsigned int guess = (bits * 1233) >> 12;
+
+    return guess + 1 - ((value < powers_of_10[guess]) ? 1 : 0);
+}
+
+/**
+*   \brief               Reads 8 ASCII digits at once.
+*   \param  str   [in]   Pointer to the 8 code units to read. All 8 must be readable.
+*   \param  value [out]  Receives the value of the digits if they are all digits.
+*   \return              True if all 8 code units are the digits '0' to '9'; false otherwise.
+*
+*   \remarks
+*       The digits are checked and converted inside a single 64-bit integer rather than one at a
+*       time. Only 8-bit strings are supported; for every other type this always returns false
+*       and the caller falls back to converting a digit at a time.
+*/
+template <typename T>
+inline bool _readeightdigits(const T *str, uint64_t *value)
+{
+    (void)str;
+    (void)value;
+
+    return false;
+}
+
+inline bool _readeightdigits(const char *str, uint64_t *value)
+{
+    uint64_t chunk;
+    memcpy(&chunk, str, sizeof(chunk));
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    chunk = __builtin_bswap64(chunk);
+#endif
+
+    // Every byte must be 0x30 to 0x39. Adding 6 pushes anything above 0x39 out of the 0x3_ row.
+    if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+    {
+        return false;
+    }
+
+    // Combine pairs of digits, then pairs of pairs, then the two halves. The first digit is in
+    // the lowest byte.
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+    *value = chunk;
+    return true;
+}
+
+/**
+*   \brief  Writes the decimal digits of \c value backwards, ending just before \c end.
+*
+*   \remarks
+*       Exactly \c digitCount characters are written, which means leading zeros are written if
+*       \c digitCount is larger than the number of digits in the value. The caller is
+*       responsible for making sure \c digitCount is large enough to hold every digit.
+*/
+template <typename T>
+inline void _writedigits(T *end, uint64_t value, unsigned int digitCount)
+{
+    while (digitCount >= 2)
+    {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+
+        *--end = (T)g_digitPairs[pair + 1];
+        *--end = (T)g_digitPairs[pair + 0];
+        digitCount -= 2;
+    }
+
+    if (digitCount > 0)
+    {
+        *--end = (T)('0' + (value % 10));
+    }
+}
+
+}
+
+#endif // DRSL_NUMERIC_PRIVATE
@@ -0,0 +1,453 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+//
+// Shortest round-trip conversion of binary floating point values to decimal. This is an
+// implementation of the Ryu algorithm described by Ulf Adams in "Ryu: Fast Float-to-String
+// Conversion" (PLDI 2018). The result is the shortest decimal mantissa/exponent pair that
+// parses back to the exact same binary value, and the closest such pair when there is a
+// choice.
+
+#ifndef DRSL_NUMERIC_RYU
+#define DRSL_NUMERIC_RYU
+
+namespace drsl
+{
+
+/**
+*   \brief  A decimal floating point value equal to mantissa * 10^exponent.
+*/
+struct _floating_decimal
+{
+    uint64_t mantissa;
+    int exponent;
+};
+
+
+// ceil(log2(5^e)) for 0 <= e <= 3528. Returns 1 for e = 0.
+inline int _pow5bits(int e)
+{
+    assert(e >= 0 && e <= 3528);
+    return (int)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650.
+inline uint32_t _log10pow2(int e)
+{
+    assert(e >= 0 && e <= 1650);
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620.
+inline uint32_t _log10pow5(int e)
+{
+    assert(e >= 0 && e <= 2620);
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+inline uint32_t _pow5factor(uint64_t value)
+{
+    uint32_t count = 0;
+    for (;;)
+    {
+        assert(value != 0);
+
+        uint64_t q = value / 5;
+        if (value - 5 * q != 0)
+        {
+            break;
+        }
+
+        value = q;
+        ++count;
+    }
+
+    return count;
+}
+
+inline bool _multipleofpow5(uint64_t value, uint32_t p)
+{
+    return _pow5factor(value) >= p;
+}
+
+inline bool _multipleofpow2(uint64_t value, uint32_t p)
+{
+    assert(p < 64);
+    return (value & ((1ULL << p) - 1)) == 0;
+}
+
+
+inline uint64_t _mulshift64(uint64_t m, const uint64_t *mul, int j)
+{
+    uint64_t high1;
+    uint64_t low1 = _mul128(m, mul[1], &high1);
+    uint64_t high0;
+    _mul128(m, mul[0], &high0);
+
+    uint64_t sum = high0 + low1;
+    if (sum < high0)
+    {
+        ++high1;
+    }
+
+    return _shiftright128(sum, high1, (unsigned int)(j - 64));
+}
+
+inline uint32_t _mulshift32(uint32_t m, uint64_t factor, int shift)
+{
+    assert(shift > 32);
+
+    uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+    uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+    uint64_t sum   = (bits0 >> 32) + bits1;
+
+    return (uint32_t)(sum >> (shift - 32));
+}
+
+
+/**
+*   \brief                     Converts the raw fields of an IEEE double to the shortest decimal representation.
+*   \param  ieeeMantissa [in]  The 52-bit mantissa field.
+*   \param  ieeeExponent [in]  The 11-bit biased exponent field.
+*   \return                    The shortest decimal that rounds back to the same double.
+*
+*   \remarks
+*       The value must be finite and non-zero.
+*/
+inline _floating_decimal _ryu_double(uint64_t ieeeMantissa, uint32_t ieeeExponent)
+{
+    int e2;
+    uint64_t m2;
+    if (ieeeExponent == 0)
+    {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieeeMantissa;
+    }
+    else
+    {
+        e2 = (int)ieeeExponent - 1023 - 52 - 2;
+        m2 = (1ULL << 52) | ieeeMantissa;
+    }
+
+    bool accept_bounds = (m2 & 1) == 0;
+
+    // The interval of values that round to this double is [mm, mp] in units of 2^e2.
+    uint64_t mv = 4 * m2;
+    uint32_t mm_shift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1 : 0;
+
+    uint64_t vr, vp, vm;
+    int e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+
+    if (e2 >= 0)
+    {
+        uint32_t q = _log10pow2(e2) - (e2 > 3);
+        e10 = (int)q;
+
+        int k = DRSL_RYU_DOUBLE_POW5_INV_BITCOUNT + _pow5bits((int)q) - 1;
+        int i = -e2 + (int)q + k;
+
+        vr = _mulshift64(4 * m2,                g_ryuDoublePow5InvSplit[q], i);
+        vp = _mulshift64(4 * m2 + 2,            g_ryuDoublePow5InvSplit[q], i);
+        vm = _mulshift64(4 * m2 - 1 - mm_shift, g_ryuDoublePow5InvSplit[q], i);
+
+        if (q <= 21)
+        {
+            // Only one of mp, mv and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0)
+            {
+                vr_trailing_zeros = _multipleofpow5(mv, q);
+            }
+            else if (accept_bounds)
+            {
+                vm_trailing_zeros = _multipleofpow5(mv - 1 - mm_shift, q);
+            }
+            else
+            {
+                vp -= _multipleofpow5(mv + 2, q);
+            }
+        }
+    }
+    else
+    {
+        uint32_t q = _log10pow5(-e2) - (-e2 > 1);
+        e10 = (int)q + e2;
+
+        int i = -e2 - (int)q;
+        int k = _pow5bits(i) - DRSL_RYU_DOUBLE_POW5_BITCOUNT;
+        int j = (int)q - k;
+
+        vr = _mulshift64(4 * m2,                g_ryuDoublePow5Split[i], j);
+        vp = _mulshift64(4 * m2 + 2,            g_ryuDoublePow5Split[i], j);
+        vm = _mulshift64(4 * m2 - 1 - mm_shift, g_ryuDoublePow5Split[i], j);
+
+        if (q <= 1)
+        {
+            // mv has at least q trailing zero bits, so {vr,vp,vm} is trailing zeros.
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+            {
+                vm_trailing_zeros = mm_shift == 1;
+            }
+            else
+            {
+                --vp;
+            }
+        }
+        else if (q < 63)
+        {
+            vr_trailing_zeros = _multipleofpow2(mv, q);
+        }
+    }
+
+
+    // Remove digits until vp and vm share the same prefix. What's left is the shortest
+    // representation, which is then rounded using the last removed digit.
+    int removed = 0;
+    uint64_t output;
+
+    if (vm_trailing_zeros || vr_trailing_zeros)
+    {
+        // The general case, which happens rarely (~0.7%).
+        uint32_t last_removed_digit = 0;
+
+        while (vp / 10 > vm / 10)
+        {
+            vm_trailing_zeros &= (vm % 10) == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+
+            last_removed_digit = (uint32_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        if (vm_trailing_zeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vr_trailing_zeros &= last_removed_digit == 0;
+
+                last_removed_digit = (uint32_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+
+        // Round half to even when the value is exactly half way.
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+        {
+            last_removed_digit = 4;
+        }
+
+        output = vr + (((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5) ? 1 : 0);
+    }
+    else
+    {
+        // The common case. Removing two digits per iteration for as long as possible is
+        // noticably faster than removing them one at a time.
+        bool round_up = false;
+
+        if (vp / 100 > vm / 100)
+        {
+            round_up = (vr % 100) >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+
+        while (vp / 10 > vm / 10)
+        {
+            round_up = (vr % 10) >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        output = vr + ((vr == vm || round_up) ? 1 : 0);
+    }
+
+    _floating_decimal result;
+    result.mantissa = output;
+    result.exponent = e10 + removed;
+
+    return result;
+}
+
+
+/**
+*   \brief                     Converts the raw fields of an IEEE float to the shortest decimal representation.
+*   \param  ieeeMantissa [in]  The 23-bit mantissa field.
+*   \param  ieeeExponent [in]  The 8-bit biased exponent field.
+*   \return                    The shortest decimal that rounds back to the same float.
+*
+*   \remarks
+*       The value must be finite and non-zero.
+*/
+inline _floating_decimal _ryu_float(uint32_t ieeeMantissa, uint32_t ieeeExponent)
+{
+    int e2;
+    uint32_t m2;
+    if (ieeeExponent == 0)
+    {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = ieeeMantissa;
+    }
+    else
+    {
+        e2 = (int)ieeeExponent - 127 - 23 - 2;
+        m2 = (1U << 23) | ieeeMantissa;
+    }
+
+    bool accept_bounds = (m2 & 1) == 0;
+
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1 : 0;
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    uint32_t last_removed_digit = 0;
+
+    if (e2 >= 0)
+    {
+        uint32_t q = _log10pow2(e2);
+        e10 = (int)q;
+
+        int k = DRSL_RYU_FLOAT_POW5_INV_BITCOUNT + _pow5bits((int)q) - 1;
+        int i = -e2 + (int)q + k;
+
+        vr = _mulshift32(mv, g_ryuFloatPow5InvSplit[q], i);
+        vp = _mulshift32(mp, g_ryuFloatPow5InvSplit[q], i);
+        vm = _mulshift32(mm, g_ryuFloatPow5InvSplit[q], i);
+
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            // We need to know one removed digit even if we are not going to loop below.
+            int l = DRSL_RYU_FLOAT_POW5_INV_BITCOUNT + _pow5bits((int)(q - 1)) - 1;
+            last_removed_digit = _mulshift32(mv, g_ryuFloatPow5InvSplit[q - 1], -e2 + (int)q - 1 + l) % 10;
+        }
+
+        if (q <= 9)
+        {
+            if (mv % 5 == 0)
+            {
+                vr_trailing_zeros = _multipleofpow5(mv, q);
+            }
+            else if (accept_bounds)
+            {
+                vm_trailing_zeros = _multipleofpow5(mm, q);
+            }
+            else
+            {
+                vp -= _multipleofpow5(mp, q);
+            }
+        }
+    }
+    else
+    {
+        uint32_t q = _log10pow5(-e2);
+        e10 = (int)q + e2;
+
+        int i = -e2 - (int)q;
+        int k = _pow5bits(i) - DRSL_RYU_FLOAT_POW5_BITCOUNT;
+        int j = (int)q - k;
+
+        vr = _mulshift32(mv, g_ryuFloatPow5Split[i], j);
+        vp = _mulshift32(mp, g_ryuFloatPow5Split[i], j);
+        vm = _mulshift32(mm, g_ryuFloatPow5Split[i], j);
+
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            j = (int)q - 1 - (_pow5bits(i + 1) - DRSL_RYU_FLOAT_POW5_BITCOUNT);
+            last_removed_digit = _mulshift32(mv, g_ryuFloatPow5Split[i + 1], j) % 10;
+        }
+
+        if (q <= 1)
+        {
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+            {
+                vm_trailing_zeros = mm_shift == 1;
+            }
+            else
+            {
+                --vp;
+            }
+        }
+        else if (q < 31)
+        {
+            vr_trailing_zeros = _multipleofpow2(mv, q - 1);
+        }
+    }
+
+
+    int removed = 0;
+    uint32_t output;
+
+    if (vm_trailing_zeros || vr_trailing_zeros)
+    {
+        while (vp / 10 > vm / 10)
+        {
+            vm_trailing_zeros &= (vm % 10) == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        if (vm_trailing_zeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vr_trailing_zeros &= last_removed_digit == 0;
+
+                last_removed_digit = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+        {
+            last_removed_digit = 4;
+        }
+
+        output = vr + (((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5) ? 1 : 0);
+    }
+    else
+    {
+        while (vp / 10 > vm / 10)
+        {
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        output = vr + ((vr == vm || last_removed_digit >= 5) ? 1 : 0);
+    }
+
+    _floating_decimal result;
+    result.mantissa = output;
+    result.exponent = e10 + removed;
+
+    return result;
+}
+
+}
+
+#endif // DRSL_NUMERIC_RYU
@@ -0,0 +1,275 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_NUMERIC_FLOATTOSTRING
+#define DRSL_NUMERIC_FLOATTOSTRING
+
+namespace drsl
+{
+
+/**
+*   \brief  The different notations floattostring() can use for a value.
+*/
+enum FLOAT_FORMAT
+{
+    /// Uses whichever of the fixed and scientific notations is shorter, preferring fixed.
+    FLOAT_FORMAT_GENERAL,
+
+    /// Positional notation without an exponent, such as "1234.5" or "0.00012".
+    FLOAT_FORMAT_FIXED,
+
+    /// One digit before the decimal point followed by an exponent, such as "1.2345e+03".
+    FLOAT_FORMAT_SCIENTIFIC
+};
+
+
+/**
+*   \brief                 Writes a decimal value to a string.
+*   \param  dest     [out] The buffer that will receive the string.
+*   \param  destSize [in]  The size in T's of the buffer pointed to by \c dest.
+*   \param  negative [in]  Whether or not the value is negative.
+*   \param  decimal  [in]  The value to write.
+*   \param  format   [in]  The notation to write the value in.
+*   \return                The number of T's required to store the string, including the null terminator.
+*/
+template <typename T>
+inline size_t _writedecimal(T *dest, size_t destSize, bool negative, const _floating_decimal &decimal, FLOAT_FORMAT format)
+{
+    char digits[20];
+    unsigned int digit_count = _decimallength17(decimal.mantissa);
+    _writedigits(digits + digit_count, decimal.mantissa, digit_count);
+
+    // The exponent of the value when written in scientific notation.
+    int sci_exponent = decimal.exponent + (int)digit_count - 1;
+    unsigned int sci_exponent_abs = (unsigned int)((sci_exponent < 0) ? -sci_exponent : sci_exponent);
+    unsigned int sci_exponent_digits = (sci_exponent_abs >= 100) ? 3 : 2;
+
+    size_t sci_length = (negative ? 1 : 0) + digit_count + ((digit_count > 1) ? 1 : 0) + 2 + sci_exponent_digits;
+
+    size_t fixed_length;
+    if (decimal.exponent >= 0)
+    {
+        fixed_length = (negative ? 1 : 0) + digit_count + decimal.exponent;
+    }
+    else if (sci_exponent >= 0)
+    {
+        fixed_length = (negative ? 1 : 0) + digit_count + 1;
+    }
+    else
+    {
+        fixed_length = (negative ? 1 : 0) + 2 + (size_t)(-sci_exponent - 1) + digit_count;
+    }
+
+    bool use_fixed = format == FLOAT_FORMAT_FIXED || (format == FLOAT_FORMAT_GENERAL && fixed_length <= sci_length);
+    size_t total_length = use_fixed ? fixed_length : sci_length;
+
+    if (dest == NULL || destSize < total_length + 1)
+    {
+        if (dest != NULL && destSize > 0)
+        {
+            dest[0] = '\0';
+        }
+
+        return total_length + 1;
+    }
+
+
+    if (negative)
+    {
+        *dest++ = '-';
+    }
+
+    if (use_fixed)
+    {
+        if (decimal.exponent >= 0)
+        {
+            for (unsigned int i = 0; i < digit_count; ++i)
+            {
+                *dest++ = (T)digits[i];
+            }
+
+            for (int i = 0; i < decimal.exponent; ++i)
+            {
+                *dest++ = '0';
+            }
+        }
+        else if (sci_exponent >= 0)
+        {
+            // The decimal point sits somewhere inside the digits.
+            unsigned int whole_digits = (unsigned int)sci_exponent + 1;
+            for (unsigned int i = 0; i < digit_count; ++i)
+            {
+                if (i == whole_digits)
+                {
+                    *dest++ = '.';
+                }
+
+                *dest++ = (T)digits[i];
+            }
+        }
+        else
+        {
+            *dest++ = '0';
+            *dest++ = '.';
+
+            for (int i = -1; i > sci_exponent; --i)
+            {
+                *dest++ = '0';
+            }
+
+            for (unsigned int i = 0; i < digit_count; ++i)
+            {
+                *dest++ = (T)digits[i];
+            }
+        }
+    }
+    else
+    {
+        *dest++ = (T)digits[0];
+
+        if (digit_count > 1)
+        {
+            *dest++ = '.';
+
+            for (unsigned int i = 1; i < digit_count; ++i)
+            {
+                *dest++ = (T)digits[i];
+            }
+        }
+
+        *dest++ = 'e';
+        *dest++ = (sci_exponent < 0) ? '-' : '+';
+
+        if (sci_exponent_digits == 3)
+        {
+            *dest++ = (T)('0' + sci_exponent_abs / 100);
+            sci_exponent_abs %= 100;
+        }
+
+        *dest++ = (T)g_digitPairs[sci_exponent_abs * 2 + 0];
+        *dest++ = (T)g_digitPairs[sci_exponent_abs * 2 + 1];
+    }
+
+    *dest = '\0';
+
+    return total_length + 1;
+}
+
+/**
+*   \brief                 Writes the name of a non-finite value ("nan", "inf" or "-inf") to a string.
+*   \return                The number of T's required to store the string, including the null terminator.
+*/
+template <typename T>
+inline size_t _writenonfinite(T *dest, size_t destSize, bool negative, bool nan)
+{
+    const char *name = nan ? "nan" : (negative ? "-inf" : "inf");
+    size_t name_length = ::strlen(name);
+
+    if (dest == NULL || destSize < name_length + 1)
+    {
+        if (dest != NULL && destSize > 0)
+        {
+            dest[0] = '\0';
+        }
+
+        return name_length + 1;
+    }
+
+    for (size_t i = 0; i <= name_length; ++i)
+    {
+        dest[i] = (T)name[i];
+    }
+
+    return name_length + 1;
+}
+
+
+/**
+*   \brief                 Converts a floating point value to the shortest string that converts back to the same value.
+*   \param  value    [in]  The value to convert.
+*   \param  dest     [out] Pointer to the buffer that will receive the string.
+*   \param  destSize [in]  The size in T's of the buffer pointed to by \c dest.
+*   \param  format   [in]  The notation to use. Defaults to FLOAT_FORMAT_GENERAL.
+*   \return                The number of T's required to store the string, including the null terminator.
+*
+*   \remarks
+*       The output contains the fewest significant digits required for the string to be parsed
+*       back to exactly the same value. When more than one string of that length would do, the
+*       one closest to the exact binary value is used.
+*       \par
+*       The output is always ASCII and is written straight into the destination regardless of
+*       its encoding. No locale is consulted; the decimal point is always '.'.
+*       \par
+*       If \c dest is NULL, or \c destSize is too small to store the whole string, nothing is
+*       written other than a null terminator (when there is room for one), and the required
+*       size is returned.
+*       \par
+*       NaN is written as "nan" and infinity as "inf" or "-inf".
+*/
+template <typename T>
+inline size_t floattostring(double value, T *dest, size_t destSize, FLOAT_FORMAT format = FLOAT_FORMAT_GENERAL)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 63) != 0;
+    uint64_t ieee_mantissa = bits & ((1ULL << 52) - 1);
+    uint32_t ieee_exponent = (uint32_t)((bits >> 52) & 0x7FF);
+
+    if (ieee_exponent == 0x7FF)
+    {
+        return _writenonfinite(dest, destSize, negative, ieee_mantissa != 0);
+    }
+
+    _floating_decimal decimal;
+    if (ieee_exponent == 0 && ieee_mantissa == 0)
+    {
+        decimal.mantissa = 0;
+        decimal.exponent = 0;
+    }
+    else
+    {
+        decimal = _ryu_double(ieee_mantissa, ieee_exponent);
+    }
+
+    return _writedecimal(dest, destSize, negative, decimal, format);
+}
+
+/// \copydoc floattostring(double, T *, size_t, FLOAT_FORMAT)
+template <typename T>
+inline size_t floattostring(float value, T *dest, size_t destSize, FLOAT_FORMAT format = FLOAT_FORMAT_GENERAL)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 31) != 0;
+    uint32_t ieee_mantissa = bits & ((1U << 23) - 1);
+    uint32_t ieee_exponent = (bits >> 23) & 0xFF;
+
+    if (ieee_exponent == 0xFF)
+    {
+        return _writenonfinite(dest, destSize, negative, ieee_mantissa != 0);
+    }
+
+    _floating_decimal decimal;
+    if (ieee_exponent == 0 && ieee_mantissa == 0)
+    {
+        decimal.mantissa = 0;
+        decimal.exponent = 0;
+    }
+    else
+    {
+        decimal = _ryu_float(ieee_mantissa, ieee_exponent);
+    }
+
+    return _writedecimal(dest, destSize, negative, decimal, format);
+}
+
+template <size_t destSize, typename U, typename T>
+inline size_t floattostring(U value, T (&dest)[destSize], FLOAT_FORMAT format = FLOAT_FORMAT_GENERAL)
+{
+    return floattostring(value, (T *)dest, destSize, format);
+}
+
+}
+
+#endif // DRSL_NUMERIC_FLOATTOSTRING
@@ -0,0 +1,196 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_NUMERIC_INTTOSTRING
+#define DRSL_NUMERIC_INTTOSTRING
+
+namespace drsl
+{
+
+/**
+*   \brief                   Writes an integer given as a sign and magnitude to a string.
+*   \param  magnitude  [in]  The absolute value of the integer.
+*   \param  negative   [in]  Whether or not a negative sign should be written.
+*   \param  dest       [out] The buffer that will receive the string.
+*   \param  destSize   [in]  The size in T's of the buffer pointed to by \c dest.
+*   \param  radix      [in]  The base to write the value in, between 2 and 36.
+*   \param  minDigits  [in]  The minimum number of digits to write. The value is padded with leading zeros.
+*   \param  uppercase  [in]  Whether or not digits above 9 should be written as upper case letters.
+*   \return                  The number of T's required to store the string, including the null terminator.
+*/
+template <typename T>
+inline size_t _writeinteger(uint64_t magnitude, bool negative, T *dest, size_t destSize, unsigned int radix, size_t minDigits, bool uppercase)
+{
+    assert(radix >= 2 && radix <= 36);
+
+    // We first need to know exactly how many digits we're writing so the value can be
+    // written straight into the destination, from the back.
+    unsigned int digit_count;
+    unsigned int shift = 0;
+
+    if (radix == 10)
+    {
+        digit_count = _decimallength(magnitude);
+    }
+    else if ((radix & (radix - 1)) == 0)
+    {
+        // Powers of two can be sized from the bit length of the value.
+        while ((1U << shift) < radix)
+        {
+            ++shift;
+        }
+
+        unsigned int bits = 64 - _clz64(magnitude | 1);
+        digit_count = (bits + shift - 1) / shift;
+    }
+    else
+    {
+        digit_count = 1;
+        for (uint64_t temp = magnitude / radix; temp != 0; temp /= radix)
+        {
+            ++digit_count;
+        }
+    }
+
+    size_t padded_count = (minDigits > digit_count) ? minDigits : digit_count;
+    size_t total_length = (negative ? 1 : 0) + padded_count;
+
+    if (dest == NULL || destSize < total_length + 1)
+    {
+        if (dest != NULL && destSize > 0)
+        {
+            dest[0] = '\0';
+        }
+
+        return total_length + 1;
+    }
+
+
+    T *end = dest + total_length;
+    *end = '\0';
+
+    if (radix == 10)
+    {
+        _writedigits(end, magnitude, digit_count);
+    }
+    else
+    {
+        const char *digits = uppercase ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+
+        T *temp = end;
+        if (shift != 0)
+        {
+            uint64_t mask = radix - 1;
+            for (unsigned int i = 0; i < digit_count; ++i)
+            {
+                *--temp = (T)digits[magnitude & mask];
+                magnitude >>= shift;
+            }
+        }
+        else
+        {
+            for (unsigned int i = 0; i < digit_count; ++i)
+            {
+                *--temp = (T)digits[magnitude % radix];
+                magnitude /= radix;
+            }
+        }
+    }
+
+    T *digits_start = end - digit_count;
+    while (digits_start > end - padded_count)
+    {
+        *--digits_start = '0';
+    }
+
+    if (negative)
+    {
+        dest[0] = '-';
+    }
+
+    return total_length + 1;
+}
+
+
+/**
+*   \brief                   Converts an integer to a string.
+*   \param  value      [in]  The value to convert.
+*   \param  dest       [out] Pointer to the buffer that will receive the string.
+*   \param  destSize   [in]  The size in T's of the buffer pointed to by \c dest.
+*   \param  radix      [in]  The base to write the value in, between 2 and 36. Defaults to 10.
+*   \param  minDigits  [in]  The minimum number of digits to write, not including the sign. Defaults to 0.
+*   \param  uppercase  [in]  Whether or not digits above 9 should be upper case letters. Defaults to false.
+*   \return                  The number of T's required to store the string, including the null terminator.
+*
+*   \remarks
+*       The digits are written straight into the destination buffer, whatever its encoding. No
+*       temporary buffer is used and nothing is allocated.
+*       \par
+*       If the value has fewer than \c minDigits digits, it is padded with leading zeros. The
+*       negative sign comes before the padding. No prefix such as "0x" is written for any radix.
+*       \par
+*       If \c dest is NULL, or \c destSize is too small to store the whole string, nothing is
+*       written other than a null terminator (when there is room for one), and the required
+*       size is returned.
+*/
+template <typename T>
+inline size_t inttostring(long long value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    uint64_t magnitude = (value < 0) ? (0 - (uint64_t)value) : (uint64_t)value;
+
+    return _writeinteger(magnitude, value < 0, dest, destSize, radix, minDigits, uppercase);
+}
+
+/// \copydoc inttostring(long long, T *, size_t, unsigned int, size_t, bool)
+template <typename T>
+inline size_t inttostring(unsigned long long value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return _writeinteger((uint64_t)value, false, dest, destSize, radix, minDigits, uppercase);
+}
+
+template <typename T>
+inline size_t inttostring(int value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+template <typename T>
+inline size_t inttostring(unsigned int value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<unsigned long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+
+template <typename T>
+inline size_t inttostring(long value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+template <typename T>
+inline size_t inttostring(unsigned long value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<unsigned long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+
+template <typename T>
+inline size_t inttostring(short value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+template <typename T>
+inline size_t inttostring(unsigned short value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<unsigned long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+
+template <typename T>
+inline size_t inttostring(signed char value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+template <typename T>
+inline size_t inttostring(unsigned char value, T *dest, size_t destSize, unsigned int radix = 10, size_t minDigits = 0, bool uppercase = false)
+{
+    return inttostring(static_cast<unsigned long long>(value), dest, destSize, radix, minDigits, uppercase);
+}
+
+}
+
+#endif // DRSL_NUMERIC_INTTOSTRING
@@ -6,6 +6,151 @@
 namespace drsl
 {
 
+// Skips the white space and '+' sign that strtod() and friends allow in front of a number.
+template <typename T>
+inline size_t _skipnumberprefix(const T *str, size_t strLength)
+{
+    size_t i = 0;
+
+    char32_t ch;
+    while ((ch = _unitat(str, strLength, i)) == ' ' || (ch >= '\t' && ch <= '\r'))
+    {
+        i += 1;
+    }
+
+    if (ch == '+' && _unitat(str, strLength, i + 1) != '-')
+    {
+        i += 1;
+    }
+
+    return i;
+}
+
+template <typename U, typename T>
+struct _parseinvariant
+{
+    static inline U call(const T *str, size_t strLength)
+    {
+        U value;
+        size_t consumed;
+
+        size_t prefix_length = _skipnumberprefix(str, strLength);
+        str += prefix_length;
+        strLength -= (strLength == (size_t)-1) ? 0 : prefix_length;
+
+        if (_tryparse<U, T>::call(str, strLength, &value, &consumed))
+        {
+            return value;
+        }
+
+        return U(0);
+    }
+};
+
+template <typename T>
+struct _parseinvariant<double, T>
+{
+    static inline double call(const T *str, size_t strLength)
+    {
+        uint64_t bits;
+        size_t consumed;
+
+        size_t prefix_length = _skipnumberprefix(str, strLength);
+        str += prefix_length;
+        strLength -= (strLength == (size_t)-1) ? 0 : prefix_length;
+
+        if (_tryparse_float(str, strLength, false, true, &bits, &consumed))
+        {
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        return 0.0;
+    }
+};
+
+template <typename T>
+struct _parseinvariant<float, T>
+{
+    static inline float call(const T *str, size_t strLength)
+    {
+        uint64_t bits;
+        size_t consumed;
+
+        size_t prefix_length = _skipnumberprefix(str, strLength);
+        str += prefix_length;
+        strLength -= (strLength == (size_t)-1) ? 0 : prefix_length;
+
+        if (_tryparse_float(str, strLength, true, true, &bits, &consumed))
+        {
+            uint32_t bits32 = (uint32_t)bits;
+
+            float value;
+            memcpy(&value, &bits32, sizeof(value));
+            return value;
+        }
+
+        return 0.0f;
+    }
+};
+
+template <typename T>
+struct _parseinvariant<bool, T>
+{
+    static inline bool call(const T *str, size_t strLength)
+    {
+        bool value;
+        size_t consumed;
+        if (_tryparse_bool(str, strLength, &value, &consumed) && (consumed == strLength || str[consumed] == '\0'))
+        {
+            return value;
+        }
+
+        // Anything else is true, the same as parse() in an English locale.
+        return true;
+    }
+};
+
+/**
+*   \brief                 Converts a string to a number without consulting the C locale.
+*   \param  str       [in] The string to convert.
+*   \param  strLength [in] The length of the string in T's, not including the null terminator.
+*   \return                The value that the string was converted to, or 0 if it isn't a valid number.
+*
+*   \remarks
+*       This behaves like parse(), but the decimal point is always '.' and neither the C library
+*       conversion functions nor the global locale are used. That means it's safe to call from
+*       any number of threads while another thread calls setlocale(), there's no locale lock to
+*       contend on, and the result is the same on every machine.
+*       \par
+*       Like strtod(), leading white space and a '+' sign are skipped and anything after the
+*       number is ignored. Floating point values are correctly rounded. Integers that are out of
+*       range of U, and floating point values too large for U, give 0.
+*       \par
+*       Booleans are false for "false" and "0" (case insensitive) and true for anything else.
+*       \par
+*       Define DRSL_LOCALE_INDEPENDENT before including drsl.h to make parse() behave like this
+*       everywhere. See tryparse() for strict validation.
+*/
+template <typename U, typename T>
+inline U parseinvariant(const T *str, size_t strLength = -1)
+{
+    if (str == NULL)
+    {
+        return U(0);
+    }
+
+    return _parseinvariant<U, T>::call(str, strLength);
+}
+
+template <typename U, typename T>
+inline U parseinvariant(const reference_string<T> &str)
+{
+    return parseinvariant<U>(str.start, length(str));
+}
+
+
 /**
 *   \brief                 Converts a string to another data type.
 *   \param  str       [in] The string to convert.
@@ -15,6 +160,10 @@ namespace drsl
 *   \remarks
 *       Explicit instantiations can be created so that custom data types can be parsed.
 *       For an example, take a look at the explicit instantiations for int's, float's etc.
+*       \par
+*       The numeric conversions use the C library, and so depend on the global locale. Use
+*       parseinvariant() for a locale independent conversion, or define DRSL_LOCALE_INDEPENDENT
+*       to make this function use parseinvariant() for every call.
 */
 // T is the string type. U is the type we are converting to (int, float, etc).
 // It's important to make U first because we want to keep the character encoding type
@@ -23,6 +172,9 @@ namespace drsl
 template <typename U, typename T>
 inline U parse(const T *str, size_t strLength = -1)
 {
+#ifdef DRSL_LOCALE_INDEPENDENT
+    return parseinvariant<U>(str, strLength);
+#else
     // If a specialisation hasn't been created for the U data type, the compiler should
     // throw an error.
 
@@ -35,8 +187,10 @@ inline U parse(const T *str, size_t strLength = -1)
     delete [] temp;
 
     return value;
+#endif
 }
 
+#ifndef DRSL_LOCALE_INDEPENDENT
 #ifdef DRSL_ONLY_ASCII
 template <> inline __int64 parse(const char *str, size_t strLength)
 {
@@ -186,25 +340,21 @@ template <> inline double parse(const wchar_t *str, size_t strLength)
 {
     (void)strLength;
 
-    return static_cast<float>(::wcstod(str, NULL));
+    return ::wcstod(str, NULL);
 }
 
 template <> inline bool parse(const wchar_t *str, size_t strLength)
 {
-    // How do we handle different languages for this? We might have to look at the locale and do
-    // specific versions based on that locale... seems like it would be quite slow, though.
-    wchar_t *locale = ::_wsetlocale(LC_ALL, NULL);
-
-    if (findfirst(locale, L"English") || findfirst(locale, L"english"))
+    // The names are always the English ones. Looking them up based on the locale made every call
+    // take the locale lock, and any locale that wasn't English returned true for everything.
+    if (str == NULL || equal(str, L"false", false, strLength) || equal(str, L"0", false, strLength))
     {
-        if (str == NULL || equal(str, L"false", false, strLength) || equal(str, L"0", false, strLength))
-        {
-            return false;
-        }
+        return false;
     }
 
     return true;
 }
+#endif  // DRSL_LOCALE_INDEPENDENT
 
 template <typename U, typename T>
 inline U parse(const reference_string<T> &str)
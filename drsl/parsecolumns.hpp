@@ -0,0 +1,219 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_PARSECOLUMNS
+#define DRSL_PARSECOLUMNS
+
+namespace drsl
+{
+
+/**
+*   \brief  The types of values a column can hold.
+*/
+enum COLUMN_TYPE
+{
+    /// Signed 64-bit integers, stored in COLUMN::int64s.
+    COLUMN_TYPE_INT64,
+
+    /// Doubles, stored in COLUMN::doubles. Plain integers are accepted as well as the tryparse() floating point syntax.
+    COLUMN_TYPE_DOUBLE,
+
+    /// References to the field inside the input buffer, stored in COLUMN::strings.
+    COLUMN_TYPE_STRING
+};
+
+/**
+*   \brief  Describes one column for parsecolumns().
+*
+*   Only the array matching \c type is used. Any of the arrays can be NULL, in which case the
+*   column is still validated but the values are thrown away.
+*/
+template <typename T>
+struct COLUMN
+{
+    /// The type of the values in the column.
+    COLUMN_TYPE type;
+
+    /// The array that receives the values of a COLUMN_TYPE_INT64 column.
+    long long *int64s;
+
+    /// The array that receives the values of a COLUMN_TYPE_DOUBLE column.
+    double *doubles;
+
+    /// The array that receives the fields of a COLUMN_TYPE_STRING column.
+    reference_string<T> *strings;
+};
+
+
+/**
+*   \brief                     Parses delimited rows of text straight into typed column arrays.
+*   \param  str          [in]  The text to parse.
+*   \param  strLength    [in]  The length in T's of the text.
+*   \param  delimiter    [in]  The code unit separating the fields of a row, such as ',' or '\\t'.
+*   \param  columns      [in]  The schema, with one entry per field in each row.
+*   \param  columnCount  [in]  The number of items in \c columns.
+*   \param  rowCapacity  [in]  The maximum number of rows to parse. Each column's array must be able to hold this many values.
+*   \param  consumed     [out] Receives the number of T's that were parsed. Can be NULL.
+*   \param  lastBatch    [in]  Whether or not the text runs to the end of the input. When false, a last row that doesn't end with a new line is left for the next batch.
+*   \return                    The number of rows that were parsed.
+*
+*   \remarks
+*       Rows are separated by new-line characters. A carriage return before the new line is
+*       ignored, empty lines are skipped and, when \c lastBatch is true, the last row does not
+*       need to end with a new line. Fields are not trimmed and quotes are not treated specially.
+*       \par
+*       Parsing stops at the first row that does not match the schema - a row with the wrong
+*       number of fields, or a numeric field that isn't a valid number for its column in its
+*       entirety. That row is not counted, but the columns before the bad field may already have
+*       been written to the slot at the returned row count, so that slot should be treated as
+*       garbage. \c consumed is set to the offset of the start of the row. Otherwise parsing
+*       stops when the text or \c rowCapacity runs out, and \c consumed is set to the offset
+*       just past the last row, which can be used to continue with the next batch.
+*       \par
+*       When the text is read in blocks that can end part way through a row, pass false for
+*       \c lastBatch for every block but the last. The unfinished row is then not counted,
+*       \c consumed stops at its start, and it can be parsed again once the rest of it has been
+*       read. As with a row that doesn't match the schema, the slot at the returned row count
+*       may have been partly written.
+*       \par
+*       This is the same as splitting each line with split() and calling parse() on each field,
+*       but no intermediate lists are built. Field boundaries are found 16 bytes at a time where
+*       SIMD is available, and digits are converted 8 at a time for 8-bit strings. Numbers are
+*       converted with tryparse(), so no locale is consulted.
+*/
+template <typename T>
+size_t parsecolumns(T *str, size_t strLength, typename _nondeduced<T>::type delimiter, const COLUMN<T> *columns, size_t columnCount, size_t rowCapacity, size_t *consumed = NULL, bool lastBatch = true)
+{
+    assert(str != NULL);
+    assert(columns != NULL);
+    assert(columnCount > 0);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    T *end = str + strLength;
+    T *row_start = str;
+    size_t row_count = 0;
+
+    while (row_count < rowCapacity && row_start < end)
+    {
+        // Empty lines are skipped.
+        if (*row_start == '\n')
+        {
+            row_start += 1;
+            continue;
+        }
+        if (*row_start == '\r' && row_start + 1 < end && row_start[1] == '\n')
+        {
+            row_start += 2;
+            continue;
+        }
+
+
+        // The fields are validated and written in the same pass. A bad field part way through
+        // the row leaves values behind in the earlier columns, in the slot at the returned row
+        // count, which is why that slot is garbage when parsing stops early.
+        T *field_start = row_start;
+        T *field_end   = row_start;
+        bool valid = true;
+
+        for (size_t iColumn = 0; iColumn < columnCount; ++iColumn)
+        {
+            // _findeither() takes const strings, so its result is turned back into an offset from the field.
+            field_end = field_start + (_findeither(field_start, end, delimiter, (T)'\n') - field_start);
+
+            // The rest of an unfinished row is in the next batch.
+            if (field_end == end && !lastBatch)
+            {
+                valid = false;
+                break;
+            }
+
+            bool last_column = (iColumn + 1 == columnCount);
+            bool at_row_end  = (field_end == end || *field_end == '\n');
+            if (last_column != at_row_end)
+            {
+                valid = false;
+                break;
+            }
+
+            // The carriage return of a "\r\n" line ending is not part of the last field.
+            T *value_end = field_end;
+            if (last_column && value_end > field_start && value_end[-1] == '\r')
+            {
+                value_end -= 1;
+            }
+
+            size_t field_length = (size_t)(value_end - field_start);
+            const COLUMN<T> &column = columns[iColumn];
+
+            if (column.type == COLUMN_TYPE_STRING)
+            {
+                if (column.strings != NULL)
+                {
+                    column.strings[row_count].start = field_start;
+                    column.strings[row_count].end   = value_end;
+                }
+            }
+            else
+            {
+                size_t value_length = 0;
+
+                if (column.type == COLUMN_TYPE_INT64)
+                {
+                    long long value;
+                    valid = _tryparse<long long, T>::call(field_start, field_length, &value, &value_length);
+
+                    if (valid && column.int64s != NULL)
+                    {
+                        column.int64s[row_count] = value;
+                    }
+                }
+                else
+                {
+                    uint64_t bits;
+                    valid = _tryparse_float(field_start, field_length, false, true, &bits, &value_length);
+
+                    if (valid && column.doubles != NULL)
+                    {
+                        memcpy(column.doubles + row_count, &bits, sizeof(double));
+                    }
+                }
+
+                if (!valid || value_length != field_length)
+                {
+                    valid = false;
+                    break;
+                }
+            }
+
+            field_start = field_end + 1;
+        }
+
+        if (!valid)
+        {
+            break;
+        }
+
+        row_count += 1;
+        row_start = (field_end < end) ? field_end + 1 : end;
+    }
+
+    if (consumed != NULL)
+    {
+        *consumed = (size_t)(row_start - str);
+    }
+
+    return row_count;
+}
+
+template <typename T>
+inline size_t parsecolumns(const reference_string<T> &str, typename _nondeduced<T>::type delimiter, const COLUMN<T> *columns, size_t columnCount, size_t rowCapacity, size_t *consumed = NULL, bool lastBatch = true)
+{
+    return parsecolumns(str.start, length(str), delimiter, columns, columnCount, rowCapacity, consumed, lastBatch);
+}
+
+}
+
+#endif // DRSL_PARSECOLUMNS
@@ -78,6 +78,194 @@ size_t replace(T *str, char32_t oldChar, char32_t newChar, size_t strSize = -1,
     return count;
 }
 
+/**
+*   \brief                   Retrieves the size of the buffer needed for replaceall() or replaceallcopy().
+*   \param  str        [in] The string the replacements are made in.
+*   \param  from       [in] The substring to replace. This must not be empty.
+*   \param  to         [in] The string to replace each occurance of \c from with.
+*   \param  strLength  [in] The length in T's of the string, not including the null terminator.
+*   \param  fromLength [in] The length in T's of \c from, not including the null terminator.
+*   \param  toLength   [in] The length in T's of \c to, not including the null terminator.
+*   \return                 The number of T's needed to store the string with every replacement made, plus the null terminator.
+*/
+template <typename T>
+size_t replaceallsize(const T *str, const T *from, const T *to, size_t strLength = -1, size_t fromLength = -1, size_t toLength = -1)
+{
+    assert(str != NULL);
+    assert(to != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    if (toLength == (size_t)-1)
+    {
+        toLength = length(to);
+    }
+
+    _substring_finder<T> finder(from, fromLength);
+    size_t count = finder.count(str, str + strLength);
+
+    return strLength - count * finder.size() + count * toLength + 1;
+}
+
+template <typename T>
+inline size_t replaceallsize(const reference_string<T> &str, const reference_string<T> &from, const reference_string<T> &to)
+{
+    return replaceallsize(str.start, from.start, to.start, length(str), length(from), length(to));
+}
+
+
+// Copies [str, end) to 'dest' with each occurance found by 'finder' replaced with 'to'. 'dest' can
+// overlap the input as long as it never gets ahead of it. Returns the end of the output.
+template <typename T>
+T * _replaceall(T *dest, const T *str, const T *end, const _substring_finder<T> &finder, const T *to, size_t toLength)
+{
+    const T *match;
+    while ((match = finder.find(str, end)) != end)
+    {
+        memmove(dest, str, (size_t)(match - str) * sizeof(T));
+        dest += match - str;
+
+        memcpy(dest, to, toLength * sizeof(T));
+        dest += toLength;
+
+        str = match + finder.size();
+    }
+
+    memmove(dest, str, (size_t)(end - str) * sizeof(T));
+    return dest + (end - str);
+}
+
+/**
+*   \brief                      Replaces each occurance of a substring in a string, in place.
+*   \param  str        [in, out] The string that should have the substring replaced.
+*   \param  from       [in]      The substring to replace. This must not be empty.
+*   \param  to         [in]      The string to replace each occurance of \c from with.
+*   \param  strSize    [in]      The size in T's of the buffer pointed to by \c str.
+*   \param  strLength  [in]      The length in T's of the input string, not including the null terminator.
+*   \param  fromLength [in]      The length in T's of \c from, not including the null terminator.
+*   \param  toLength   [in]      The length in T's of \c to, not including the null terminator.
+*   \return                      The number of T's that must be allocated in the strings buffer in order to store the modified string.
+*
+*   \remarks
+*       If \c strSize is equal to -1, the function will assume that the buffer is large enough to
+*       store the modified string. If it's too small, the string is left untouched.
+*       \par
+*       Occurances are found from left to right and don't overlap, so replacing "aa" in "aaa"
+*       replaces the first two characters only. The substring is matched code unit by code unit,
+*       which works for any encoding.
+*       \par
+*       The string is rewritten in a single pass. When \c to is longer than \c from, the
+*       occurances are counted first, and the string is moved to the end of the space it will
+*       take up so the output can be written from the front without catching up with the input.
+*       The result is null terminated if there is room for it.
+*/
+template <typename T>
+size_t replaceall(T *str, const T *from, const T *to, size_t strSize = -1, size_t strLength = -1, size_t fromLength = -1, size_t toLength = -1)
+{
+    assert(str != NULL);
+    assert(to != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    if (toLength == (size_t)-1)
+    {
+        toLength = length(to);
+    }
+
+    _substring_finder<T> finder(from, fromLength);
+
+    T *end = str + strLength;
+    if (toLength <= finder.size())
+    {
+        // The output is never longer than the input, so it can be written over it straight away.
+        T *result_end = _replaceall(str, str, end, finder, to, toLength);
+        if (strSize == (size_t)-1 || (size_t)(result_end - str) < strSize)
+        {
+            *result_end = '\0';
+        }
+
+        return (size_t)(result_end - str) + 1;
+    }
+
+    size_t count = finder.count(str, end);
+    size_t result_size = strLength + count * (toLength - finder.size()) + 1;
+    if (count == 0 || (strSize != (size_t)-1 && result_size > strSize))
+    {
+        return result_size;
+    }
+
+    T *moved = str + (result_size - 1 - strLength);
+    memmove(moved, str, strLength * sizeof(T));
+
+    T *result_end = _replaceall(str, moved, moved + strLength, finder, to, toLength);
+    *result_end = '\0';
+
+    return result_size;
+}
+
+
+/**
+*   \brief                       Copies a string with each occurance of a substring replaced.
+*   \param  dest       [out]     The buffer that will recieve the new string. Can be NULL, in which case nothing is written.
+*   \param  str        [in]      The string to copy. This must not overlap \c dest.
+*   \param  from       [in]      The substring to replace. This must not be empty.
+*   \param  to         [in]      The string to replace each occurance of \c from with.
+*   \param  destSize   [in]      The size in T's of the buffer pointed to by \c dest.
+*   \param  strLength  [in]      The length in T's of the input string, not including the null terminator.
+*   \param  fromLength [in]      The length in T's of \c from, not including the null terminator.
+*   \param  toLength   [in]      The length in T's of \c to, not including the null terminator.
+*   \return                      The number of T's that must be allocated in \c dest in order to store the new string.
+*
+*   \remarks
+*       If \c destSize is equal to -1, the function will assume that the buffer is large enough, and
+*       the string is copied in a single pass. Otherwise the occurances are counted first, and
+*       nothing is written if the buffer is too small. See replaceall() for how occurances are found.
+*/
+template <typename T>
+size_t replaceallcopy(T *dest, const T *str, const T *from, const T *to, size_t destSize = -1, size_t strLength = -1, size_t fromLength = -1, size_t toLength = -1)
+{
+    assert(str != NULL);
+    assert(to != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    if (toLength == (size_t)-1)
+    {
+        toLength = length(to);
+    }
+
+    if (dest == NULL || destSize != (size_t)-1)
+    {
+        size_t result_size = replaceallsize(str, from, to, strLength, fromLength, toLength);
+        if (dest == NULL || result_size > destSize)
+        {
+            return result_size;
+        }
+    }
+
+    _substring_finder<T> finder(from, fromLength);
+
+    T *result_end = _replaceall(dest, str, str + strLength, finder, to, toLength);
+    *result_end = '\0';
+
+    return (size_t)(result_end - dest) + 1;
+}
+
+template <typename T>
+inline size_t replaceallcopy(T *dest, const reference_string<T> &str, const reference_string<T> &from, const reference_string<T> &to, size_t destSize = -1)
+{
+    return replaceallcopy(dest, str.start, from.start, to.start, destSize, length(str), length(from), length(to));
+}
+
 
 }
 
@@ -615,6 +615,20 @@ public:
         return this->append(temp);
     }
 
+    // Numbers are written straight into the end of the string without going through a
+    // temporary buffer.
+    slow_string<T> & operator << (int value)                { return this->appendnumber(value); }
+    slow_string<T> & operator << (unsigned int value)       { return this->appendnumber(value); }
+    slow_string<T> & operator << (long value)               { return this->appendnumber(value); }
+    slow_string<T> & operator << (unsigned long value)      { return this->appendnumber(value); }
+    slow_string<T> & operator << (long long value)          { return this->appendnumber(value); }
+    slow_string<T> & operator << (unsigned long long value) { return this->appendnumber(value); }
+    slow_string<T> & operator << (short value)              { return this->appendnumber(value); }
+    slow_string<T> & operator << (unsigned short value)     { return this->appendnumber(value); }
+    slow_string<T> & operator << (float value)              { return this->appendnumber(value); }
+    slow_string<T> & operator << (double value)             { return this->appendnumber(value); }
+    slow_string<T> & operator << (bool value)               { return this->appendnumber(value); }
+
     template <typename U>
     slow_string<T> & operator << (U *value)
     {
@@ -636,6 +650,42 @@ public:
 
 private:
 
+    /**
+    *   \brief             Appends a number to the end of this string.
+    *   \param  value [in] The value to append.
+    *   \return            A reference to this string.
+    *
+    *   \remarks
+    *       The size of the converted value is determined first so that it can be written
+    *       directly into the newly allocated buffer.
+    */
+    template <typename U>
+    slow_string<T> & appendnumber(U value)
+    {
+        size_t value_size = drsl::tostring(value, (T *)NULL, 0);
+
+        // Now we need to find the length of this string.
+        size_t this_size = this->length();
+
+        // Now grab our current pointer so we can copy it into our new memory space later.
+        T *old_data = this->data;
+
+        // The value size includes the null terminator.
+        this->data = new T[this_size + value_size];
+
+        // Copy our old data back into the string.
+        memcpy(this->data, old_data, sizeof(T) * this_size);
+
+        // Now write the value straight after the old data.
+        drsl::tostring(value, this->data + this_size, value_size);
+
+        // Delete our previous data.
+        delete [] old_data;
+
+        return *this;
+    }
+
+
     /// Pointer to the content of the string.
     T *data;
 
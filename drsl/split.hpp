@@ -6,6 +6,147 @@
 namespace drsl
 {
 
+/**
+*   \brief  Structure describing the options for splitting a string.
+*
+*   The defaults are the same as split() with a list.
+*/
+struct SPLIT_OPTIONS
+{
+    /**
+    *   \brief  Constructor.
+    */
+    SPLIT_OPTIONS()
+        : includeDelimiter(true), keepEmpty(false), maxSplits((size_t)-1)
+    {
+    }
+
+    /// Whether or not each piece includes the delimiter that ends it.
+    bool includeDelimiter;
+
+    /// Whether or not empty pieces are kept. Set this for CSV style fields, where "a,,b" is three
+    /// fields and "a," is two. An empty string is then a single empty piece.
+    bool keepEmpty;
+
+    /// The maximum number of delimiters to split at. Everything after the last split is returned
+    /// as one piece, delimiters and all. (size_t)-1 means there is no limit.
+    size_t maxSplits;
+};
+
+
+/**
+*   \brief  The state of a split in progress, shared by split(), splitforeach() and split_range.
+*/
+template <typename T>
+class _split_cursor
+{
+public:
+
+    // A cursor with no pieces left.
+    _split_cursor()
+        : current(NULL), end(NULL), finder(), options(), splitCount(0), finished(true)
+    {
+    }
+
+    // For a null terminated string the end is found while looking for delimiters, so nothing past
+    // the last piece that's asked for is ever read.
+    _split_cursor(T *str, const T *delimiter, const SPLIT_OPTIONS *options, size_t strLength, size_t delLength)
+        : current(str), end(NULL), finder(delimiter, delLength), options(), splitCount(0), finished(false)
+    {
+        assert(str != NULL);
+
+        if (strLength != (size_t)-1)
+        {
+            this->end = str + strLength;
+        }
+
+        if (options != NULL)
+        {
+            this->options = *options;
+        }
+    }
+
+    // Retrieves the next piece. Returns false when there are no more.
+    bool next(reference_string<T> &piece)
+    {
+        while (!this->finished)
+        {
+            T *found = NULL;
+            if (this->splitCount < this->options.maxSplits)
+            {
+                if (this->end != NULL)
+                {
+                    found = this->current + (this->finder.find(this->current, this->end) - this->current);
+                    if (found == this->end)
+                    {
+                        found = NULL;
+                    }
+                }
+                else
+                {
+                    found = this->current + (this->finder.findterminated(this->current) - this->current);
+                    if (*found == '\0')
+                    {
+                        this->end = found;
+                        found = NULL;
+                    }
+                }
+            }
+
+            if (found == NULL && this->end == NULL)
+            {
+                this->end = this->current + length(this->current);
+            }
+
+            piece.start = this->current;
+            if (found != NULL)
+            {
+                piece.end = this->options.includeDelimiter ? found + this->finder.size() : found;
+
+                this->current = found + this->finder.size();
+                this->splitCount += 1;
+            }
+            else
+            {
+                // The rest of the string is the last piece.
+                piece.end = this->end;
+
+                this->current = this->end;
+                this->finished = true;
+            }
+
+            if (piece.end != piece.start || this->options.keepEmpty)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+private:
+
+    /// Where the search for the next delimiter starts.
+    T *current;
+
+    /// The end of the string, or NULL until it's found for a null terminated string.
+    T *end;
+
+    /// The delimiter.
+    _substring_finder<T> finder;
+
+    /// A copy of the options.
+    SPLIT_OPTIONS options;
+
+    /// The number of delimiters split at so far.
+    size_t splitCount;
+
+    /// Whether or not the last piece has been returned.
+    bool finished;
+};
+
+
 /**
 *   \brief                         Splits a string and places each part in a list.
 *   \param  str              [in]  The string to split.
@@ -16,67 +157,224 @@ namespace drsl
 *   \param  delLength        [in]  The length in T's of the delimiter string, not including the null terminator.
 *
 *   \remarks
-*       Empty strings are never added to the list.
+*       Empty strings are never added to the list. Use splitforeach() or the range returned by
+*       split(str, delimiter, options) to keep them, or to avoid building a list at all.
 */
 template <typename T>
-void split(T *str, const T *delimiter, std::vector<reference_string<T> > &list, bool includeDelimiter = true, size_t strLength = (size_t)-1, size_t delLength = (size_t)-1)
+void split(T *str, const typename _nondeduced<T>::type *delimiter, std::vector<reference_string<T> > &list, bool includeDelimiter = true, size_t strLength = (size_t)-1, size_t delLength = (size_t)-1)
 {
-    assert(str != NULL);
+    SPLIT_OPTIONS options;
+    options.includeDelimiter = includeDelimiter;
 
-	// The current piece.
-    reference_string<T> cur_string;
+    _split_cursor<T> cursor(str, delimiter, &options, strLength, delLength);
 
-    if (delLength == (size_t)-1)
+    reference_string<T> piece;
+    while (cursor.next(piece))
     {
-        delLength = length(delimiter);
+        list.push_back(piece);
     }
+}
 
-    T *temp = str;
 
-    // Now we need to keep searching for our delimiter until we don't find any more.
-    while (strLength > 0 && (temp = findfirst(str, delimiter, strLength, delLength)) != NULL)
+/**
+*   \brief                   Splits a string, passing each part to a callback as it's found.
+*   \param  str       [in]   The string to split.
+*   \param  delimiter [in]   The string that is used to determine where the string should be split.
+*   \param  callback  [in]   The function or function object to call with each piece, as a reference_string<T>. It returns false to stop splitting.
+*   \param  options   [in]   The options to split with. Can be NULL, in which case the defaults in SPLIT_OPTIONS are used.
+*   \param  strLength [in]   The length in T's of the string, not including the null terminator.
+*   \param  delLength [in]   The length in T's of the delimiter string, not including the null terminator.
+*   \return                  False if the callback stopped the split; true otherwise.
+*
+*   \remarks
+*       The string is split in a single pass and nothing is allocated.
+*/
+template <typename T, typename Callback>
+bool splitforeach(T *str, const typename _nondeduced<T>::type *delimiter, Callback callback, const SPLIT_OPTIONS *options = NULL, size_t strLength = (size_t)-1, size_t delLength = (size_t)-1)
+{
+    _split_cursor<T> cursor(str, delimiter, options, strLength, delLength);
+
+    reference_string<T> piece;
+    while (cursor.next(piece))
     {
-        cur_string.start = str;
+        if (!callback(piece))
+        {
+            return false;
+        }
+    }
 
-        // If we're not including the delimiter, the end will simply be equal to 'temp'. Otherwise, it
-        // will be equal to 'temp' + length of delimiter.
-        if (!includeDelimiter)
+    return true;
+}
+
+
+/**
+*   \brief  A range over the pieces of a split string, as returned by split(str, delimiter, options).
+*
+*   Nothing is split until the range is iterated, and then only one piece at a time, so breaking
+*   out of a loop early leaves the rest of the string untouched. The string and delimiter are
+*   referenced, not copied, so they must stay around for as long as the range is used.
+*/
+template <typename T>
+class split_range
+{
+public:
+
+    /**
+    *   \brief  Iterator over the pieces of a split_range.
+    */
+    class iterator
+    {
+    public:
+
+        typedef std::input_iterator_tag iterator_category;
+        typedef reference_string<T>      value_type;
+        typedef ptrdiff_t                difference_type;
+        typedef const reference_string<T> * pointer;
+        typedef const reference_string<T> & reference;
+
+
+        /**
+        *   \brief  Default constructor. This is the end iterator.
+        */
+        iterator()
+            : cursor(), atEnd(true), piece()
         {
-            cur_string.end = temp;
         }
-        else
+
+        /**
+        *   \brief  Constructor. Moves to the first piece straight away.
+        */
+        explicit iterator(const _split_cursor<T> &cursor)
+            : cursor(cursor), atEnd(false), piece()
         {
-            cur_string.end = temp + delLength;
+            this->_next();
         }
 
-        if (length(cur_string) > 0)
+
+        reference operator*() const
         {
-            list.push_back(cur_string);
+            assert(!this->atEnd);
+            return this->piece;
         }
 
-        strLength -= (temp - str) + delLength;
+        pointer operator->() const
+        {
+            assert(!this->atEnd);
+            return &this->piece;
+        }
 
-        // We need to move past the delimiter that we just found.
-        str = temp + delLength;
-    }
+        iterator & operator++()
+        {
+            assert(!this->atEnd);
+            this->_next();
 
-    // We need to make sure that we have our very last part.
-    if (strLength > 0)
-    {
-        cur_string.start = str;
-        cur_string.end = str;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++(*this);
+
+            return temp;
+        }
+
+
+        // Iterators are only compared against the end iterator in practice. Two iterators are
+        // equal if they're both at the end, or both on the same piece.
+        bool operator==(const iterator &other) const
+        {
+            if (this->atEnd || other.atEnd)
+            {
+                return this->atEnd == other.atEnd;
+            }
+
+            return this->piece.start == other.piece.start && this->piece.end == other.piece.end;
+        }
 
-        char32_t ch;
-        while (strLength > 0 && (ch = nextchar(cur_string.end)) != NULL)
+        bool operator!=(const iterator &other) const
         {
-            strLength -= charwidth<T>(ch);
-        };
+            return !(*this == other);
+        }
+
 
-        if (length(cur_string) > 0)
+    private:
+
+        void _next()
         {
-            list.push_back(cur_string);
+            if (!this->cursor.next(this->piece))
+            {
+                this->atEnd = true;
+            }
         }
+
+
+        /// The split in progress.
+        _split_cursor<T> cursor;
+
+        /// Whether or not this is the end iterator.
+        bool atEnd;
+
+        /// The current piece.
+        reference_string<T> piece;
+    };
+
+    typedef iterator const_iterator;
+
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to split.
+    *   \param  delimiter [in] The delimiter.
+    *   \param  options   [in] The options to split with. Can be NULL.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    *   \param  delLength [in] The length in T's of the delimiter string, not including the null terminator.
+    */
+    split_range(T *str, const T *delimiter, const SPLIT_OPTIONS *options, size_t strLength = (size_t)-1, size_t delLength = (size_t)-1)
+        : cursor(str, delimiter, options, strLength, delLength)
+    {
+    }
+
+
+    /**
+    *   \brief  Retrieves an iterator to the first piece.
+    */
+    iterator begin() const
+    {
+        return iterator(this->cursor);
     }
+
+    /**
+    *   \brief  Retrieves the end iterator.
+    */
+    iterator end() const
+    {
+        return iterator();
+    }
+
+
+private:
+
+    /// The state of the split before the first piece.
+    _split_cursor<T> cursor;
+};
+
+
+/**
+*   \brief                 Retrieves a range over the pieces of a split string, for use in range-based for loops.
+*   \param  str       [in] The string to split.
+*   \param  delimiter [in] The string that is used to determine where the string should be split.
+*   \param  options   [in] The options to split with. Can be NULL, in which case the defaults in SPLIT_OPTIONS are used.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \param  delLength [in] The length in T's of the delimiter string, not including the null terminator.
+*
+*   \remarks
+*       This finds the same pieces as splitforeach(), one at a time as the loop asks for them.
+*/
+template <typename T>
+inline split_range<T> split(T *str, const typename _nondeduced<T>::type *delimiter, const SPLIT_OPTIONS *options = NULL, size_t strLength = (size_t)-1, size_t delLength = (size_t)-1)
+{
+    return split_range<T>(str, delimiter, options, strLength, delLength);
 }
 
 }
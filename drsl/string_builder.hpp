@@ -0,0 +1,153 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_STRING_BUILDER
+#define DRSL_STRING_BUILDER
+
+namespace drsl
+{
+
+/**
+*   \brief  Class for building up a string from many pieces.
+*
+*   append() takes the same pieces as concat(): strings of any character type, reference_string's,
+*   slow_string's, single characters and numbers. All of the pieces given to one call are
+*   measured first, so the buffer grows at most once per call, and each piece is then copied
+*   straight to the end of the string. The length is kept track of, so unlike slow_string::append()
+*   nothing already in the builder is measured or copied again, other than when the buffer grows.
+*   The buffer at least doubles when it grows. For example:
+*
+*       string_builder<char> sql;
+*       sql.append("SELECT * FROM ", table, " WHERE id = ", id);
+*       sql.append(" LIMIT ", limit);
+*
+*       execute(sql.c_str(), sql.length());
+*/
+template <typename T>
+class string_builder
+{
+public:
+
+    /**
+    *   \brief  Constructor. The string starts empty.
+    */
+    string_builder()
+        : buffer(1, '\0')
+    {
+    }
+
+    /**
+    *   \brief                Constructor.
+    *   \param  capacity [in] The number of T's to make room for up front, not including the null terminator.
+    */
+    explicit string_builder(size_t capacity)
+        : buffer(1, '\0')
+    {
+        this->buffer.reserve(capacity + 1);
+    }
+
+
+    /**
+    *   \brief             Appends any number of pieces to the end of the string.
+    *   \param  parts [in] The pieces to append, in order. See concat() for what they can be.
+    *   \return            A reference to this object.
+    *
+    *   \remarks
+    *       Pieces can point into this builder, so sb.append(sb.c_str()) doubles the string.
+    */
+    template <typename... Parts>
+    string_builder<T> & append(const Parts &... parts)
+    {
+        _concat_piece<T> pieces[sizeof...(Parts) + 1];
+        size_t size = _measurepieces(pieces, parts...);
+
+        // The null terminator is overwritten by the first piece.
+        size_t old_length = this->length();
+        size_t new_size   = old_length + size + 1;
+
+        if (new_size <= this->buffer.capacity())
+        {
+            this->buffer.resize(new_size);
+            *_writepieces(&this->buffer[old_length], pieces, sizeof...(Parts)) = '\0';
+        }
+        else
+        {
+            // Pieces can point into this builder, such as from c_str() or text(), so the old buffer
+            // has to stay around until they've been copied.
+            std::vector<T> grown;
+            grown.reserve((std::max)(new_size, this->buffer.capacity() * 2));
+            grown.assign(this->buffer.begin(), this->buffer.end() - 1);
+            grown.resize(new_size);
+
+            *_writepieces(&grown[old_length], pieces, sizeof...(Parts)) = '\0';
+            this->buffer.swap(grown);
+        }
+
+        return *this;
+    }
+
+    /**
+    *   \brief  Removes everything from the string. The memory is kept for reuse.
+    */
+    void clear()
+    {
+        this->buffer.resize(1);
+        this->buffer[0] = '\0';
+    }
+
+    /**
+    *   \brief                Makes sure the string can grow to the given length without reallocating.
+    *   \param  capacity [in] The length in T's to make room for, not including the null terminator.
+    */
+    void reserve(size_t capacity)
+    {
+        this->buffer.reserve(capacity + 1);
+    }
+
+
+    /**
+    *   \brief  Retrieves the string. It's always null terminated, and is valid until the next call to append(), clear() or reserve().
+    */
+    const T * c_str() const
+    {
+        return &this->buffer[0];
+    }
+
+    /**
+    *   \brief  Retrieves the string as a reference_string. This is valid until the next call to append(), clear() or reserve().
+    */
+    reference_string<const T> text() const
+    {
+        reference_string<const T> result;
+        result.start = &this->buffer[0];
+        result.end   = result.start + this->length();
+
+        return result;
+    }
+
+    /**
+    *   \brief  Retrieves the length in T's of the string, not including the null terminator.
+    */
+    size_t length() const
+    {
+        return this->buffer.size() - 1;
+    }
+
+    /**
+    *   \brief  Determines whether or not the string is empty.
+    */
+    bool empty() const
+    {
+        return this->buffer.size() == 1;
+    }
+
+
+
+private:
+
+    /// The string, including the null terminator.
+    std::vector<T> buffer;
+};
+
+}
+
+#endif // DRSL_STRING_BUILDER
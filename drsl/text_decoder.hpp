@@ -0,0 +1,676 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TEXT_DECODER
+#define DRSL_TEXT_DECODER
+
+namespace drsl
+{
+
+/**
+*   \brief  The encodings that detectencoding() and text_decoder know about.
+*/
+enum TEXT_ENCODING
+{
+    /// Not known. A text_decoder given this works out the encoding from the first bytes it sees.
+    TEXT_ENCODING_UNKNOWN,
+
+    TEXT_ENCODING_UTF8,
+    TEXT_ENCODING_UTF16LE,
+    TEXT_ENCODING_UTF16BE,
+    TEXT_ENCODING_UTF32LE,
+    TEXT_ENCODING_UTF32BE
+};
+
+
+// Retrieves the BOM of an encoding as bytes.
+inline const unsigned char * _encodingbom(TEXT_ENCODING encoding, size_t &bomSize)
+{
+    static const unsigned char utf8[]    = {0xEF, 0xBB, 0xBF};
+    static const unsigned char utf16le[] = {0xFF, 0xFE};
+    static const unsigned char utf16be[] = {0xFE, 0xFF};
+    static const unsigned char utf32le[] = {0xFF, 0xFE, 0x00, 0x00};
+    static const unsigned char utf32be[] = {0x00, 0x00, 0xFE, 0xFF};
+
+    switch (encoding)
+    {
+    case TEXT_ENCODING_UTF8:    bomSize = sizeof(utf8);    return utf8;
+    case TEXT_ENCODING_UTF16LE: bomSize = sizeof(utf16le); return utf16le;
+    case TEXT_ENCODING_UTF16BE: bomSize = sizeof(utf16be); return utf16be;
+    case TEXT_ENCODING_UTF32LE: bomSize = sizeof(utf32le); return utf32le;
+    case TEXT_ENCODING_UTF32BE: bomSize = sizeof(utf32be); return utf32be;
+    default: break;
+    }
+
+    bomSize = 0;
+    return NULL;
+}
+
+
+// Decodes a character from [src, end) and moves past it. These return false without moving if the
+// bytes run out part way through a character. Anything invalid becomes UNI_REPLACEMENT_CHAR.
+//
+// For UTF-8 a replacement character is given for each maximal part of an invalid sequence, which
+// is what Unicode recommends: a lead byte followed by something other than a continuation byte is
+// one replacement, and the byte that broke the sequence is then decoded on its own.
+inline bool _decodeutf8(const unsigned char *&src, const unsigned char *end, char32_t &ch)
+{
+    unsigned char lead = *src;
+    if (lead < 0x80)
+    {
+        ch = lead;
+        src += 1;
+        return true;
+    }
+
+    // The range of the second byte is narrower for some lead bytes. This rules out overlong
+    // forms, surrogates and anything past U+10FFFF.
+    size_t length;
+    char32_t value;
+    unsigned char low  = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        value  = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        value  = lead & 0x0F;
+        low    = (lead == 0xE0) ? 0xA0 : 0x80;
+        high   = (lead == 0xED) ? 0x9F : 0xBF;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        value  = lead & 0x07;
+        low    = (lead == 0xF0) ? 0x90 : 0x80;
+        high   = (lead == 0xF4) ? 0x8F : 0xBF;
+    }
+    else
+    {
+        ch = UNI_REPLACEMENT_CHAR;
+        src += 1;
+        return true;
+    }
+
+    const unsigned char *temp = src + 1;
+    for (size_t i = 1; i < length; ++i, ++temp)
+    {
+        if (temp == end)
+        {
+            return false;
+        }
+
+        if (*temp < low || *temp > high)
+        {
+            ch = UNI_REPLACEMENT_CHAR;
+            src = temp;
+            return true;
+        }
+
+        value = (value << 6) | (*temp & 0x3F);
+        low  = 0x80;
+        high = 0xBF;
+    }
+
+    ch = value;
+    src = temp;
+    return true;
+}
+
+inline char32_t _readunit16(const unsigned char *src, bool bigEndian)
+{
+    return bigEndian ? (((char32_t)src[0] << 8) | src[1]) : (src[0] | ((char32_t)src[1] << 8));
+}
+
+inline bool _decodeutf16(const unsigned char *&src, const unsigned char *end, bool bigEndian, char32_t &ch)
+{
+    if (end - src < 2)
+    {
+        return false;
+    }
+
+    char32_t unit = _readunit16(src, bigEndian);
+    if (unit < UNI_SUR_HIGH_START || unit > UNI_SUR_LOW_END)
+    {
+        ch = unit;
+        src += 2;
+        return true;
+    }
+
+    // A low surrogate on its own.
+    if (unit >= UNI_SUR_LOW_START)
+    {
+        ch = UNI_REPLACEMENT_CHAR;
+        src += 2;
+        return true;
+    }
+
+    if (end - src < 4)
+    {
+        return false;
+    }
+
+    // A high surrogate that isn't followed by a low one is replaced on its own.
+    char32_t unit2 = _readunit16(src + 2, bigEndian);
+    if (unit2 < UNI_SUR_LOW_START || unit2 > UNI_SUR_LOW_END)
+    {
+        ch = UNI_REPLACEMENT_CHAR;
+        src += 2;
+        return true;
+    }
+
+    ch = ((unit - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (unit2 - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+    src += 4;
+    return true;
+}
+
+inline bool _decodeutf32(const unsigned char *&src, const unsigned char *end, bool bigEndian, char32_t &ch)
+{
+    if (end - src < 4)
+    {
+        return false;
+    }
+
+    char32_t value;
+    if (bigEndian)
+    {
+        value = ((char32_t)src[0] << 24) | ((char32_t)src[1] << 16) | ((char32_t)src[2] << 8) | src[3];
+    }
+    else
+    {
+        value = src[0] | ((char32_t)src[1] << 8) | ((char32_t)src[2] << 16) | ((char32_t)src[3] << 24);
+    }
+
+    if (value > UNI_MAX_LEGAL_UTF32 || (value >= UNI_SUR_HIGH_START && value <= UNI_SUR_LOW_END))
+    {
+        value = UNI_REPLACEMENT_CHAR;
+    }
+
+    ch = value;
+    src += 4;
+    return true;
+}
+
+inline bool _decodechar(TEXT_ENCODING encoding, const unsigned char *&src, const unsigned char *end, char32_t &ch)
+{
+    switch (encoding)
+    {
+    case TEXT_ENCODING_UTF16LE: return _decodeutf16(src, end, false, ch);
+    case TEXT_ENCODING_UTF16BE: return _decodeutf16(src, end, true,  ch);
+    case TEXT_ENCODING_UTF32LE: return _decodeutf32(src, end, false, ch);
+    case TEXT_ENCODING_UTF32BE: return _decodeutf32(src, end, true,  ch);
+    default: break;
+    }
+
+    return _decodeutf8(src, end, ch);
+}
+
+// Determines whether or not [src, end) is valid in an encoding, ignoring a character cut off at the end.
+inline bool _isvalidencoding(TEXT_ENCODING encoding, const unsigned char *src, const unsigned char *end)
+{
+    char32_t ch;
+    while (src < end && _decodechar(encoding, src, end, ch))
+    {
+        if (ch == UNI_REPLACEMENT_CHAR)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+*   \brief                 Works out the encoding of some text from its bytes.
+*   \param  data     [in]  The bytes.
+*   \param  size     [in]  The number of bytes.
+*   \param  bomSize  [out] Receives the size in bytes of the BOM, or 0 if there isn't one. Can be NULL.
+*   \return                The encoding. This is TEXT_ENCODING_UTF8 if nothing else fits.
+*
+*   \remarks
+*       A BOM decides the encoding on its own. UTF-32LE is checked for before UTF-16LE, so UTF-16LE
+*       text starting with a BOM and then U+0000 is taken to be UTF-32LE.
+*       \par
+*       Without a BOM, the zero bytes in the first 4KB are counted by their position in each group
+*       of four bytes. ASCII characters in UTF-16 and UTF-32 have their zero bytes in fixed places,
+*       which gives away both the code unit size and the byte order, whereas real UTF-8 text almost
+*       never has zero bytes. When there's no pattern, the text is taken to be UTF-8. UTF-16 text
+*       with no BOM and hardly any ASCII or Latin-1 characters is not recognised.
+*/
+inline TEXT_ENCODING detectencoding(const void *data, size_t size, size_t *bomSize = NULL)
+{
+    assert(data != NULL || size == 0);
+
+    const unsigned char *bytes = (const unsigned char *)data;
+
+    if (bomSize != NULL)
+    {
+        *bomSize = 0;
+    }
+
+    // UTF-32LE goes first because its BOM starts with the UTF-16LE one.
+    static const TEXT_ENCODING bom_order[] = {TEXT_ENCODING_UTF32LE, TEXT_ENCODING_UTF32BE, TEXT_ENCODING_UTF8, TEXT_ENCODING_UTF16LE, TEXT_ENCODING_UTF16BE};
+    for (size_t i = 0; i < sizeof(bom_order) / sizeof(bom_order[0]); ++i)
+    {
+        size_t bom_size;
+        const unsigned char *bom = _encodingbom(bom_order[i], bom_size);
+        if (size >= bom_size && memcmp(bytes, bom, bom_size) == 0)
+        {
+            if (bomSize != NULL)
+            {
+                *bomSize = bom_size;
+            }
+
+            return bom_order[i];
+        }
+    }
+
+
+    const size_t sample_size = (size < 4096) ? size : 4096;
+
+    size_t zeros[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < sample_size; ++i)
+    {
+        if (bytes[i] == 0)
+        {
+            zeros[i % 4] += 1;
+        }
+    }
+
+    // UTF-32 always has a zero top byte, and the next one is zero for the basic multilingual
+    // plane. The other end of each unit is only zero for U+0000, which rules out a run of zeros.
+    size_t quads = sample_size / 4;
+    if (quads > 0)
+    {
+        if (zeros[3] >= quads * 9 / 10 && zeros[2] >= quads / 2 && zeros[0] < quads / 2 && _isvalidencoding(TEXT_ENCODING_UTF32LE, bytes, bytes + quads * 4))
+        {
+            return TEXT_ENCODING_UTF32LE;
+        }
+
+        if (zeros[0] >= quads * 9 / 10 && zeros[1] >= quads / 2 && zeros[3] < quads / 2 && _isvalidencoding(TEXT_ENCODING_UTF32BE, bytes, bytes + quads * 4))
+        {
+            return TEXT_ENCODING_UTF32BE;
+        }
+    }
+
+    // UTF-16 has a zero high byte for every ASCII and Latin-1 character, and a zero low byte much
+    // less often. Stray zero bytes in UTF-8 land evenly on both sides, so one side has to win clearly.
+    size_t pairs = sample_size / 2;
+    size_t odd   = zeros[1] + zeros[3];
+    size_t even  = zeros[0] + zeros[2];
+    if (pairs > 0)
+    {
+        if (odd >= pairs / 10 && odd > 0 && even * 4 <= odd)
+        {
+            return TEXT_ENCODING_UTF16LE;
+        }
+
+        if (even >= pairs / 10 && even > 0 && odd * 4 <= even)
+        {
+            return TEXT_ENCODING_UTF16BE;
+        }
+    }
+
+    return TEXT_ENCODING_UTF8;
+}
+
+
+/**
+*   \brief  Class for converting a stream of bytes in a UTF encoding to a string of T's.
+*
+*   The bytes can be given in chunks of any size, split anywhere. A character cut off at the end
+*   of a chunk is held on to and finished off with the start of the next one, so the result is
+*   the same as decoding all of the bytes at once. Call finish() after the last chunk.
+*
+*   A BOM at the start of the stream is skipped. If the encoding isn't given, it's worked out with
+*   detectencoding() from the first few KB of the stream that have been given by the time there
+*   are at least four bytes, so the first chunk should be a few KB if possible.
+*   Invalid sequences become U+FFFD.
+*
+*   Runs of ASCII in UTF-8 input are checked and copied 16 bytes at a time, which is most of the
+*   work for typical text. UTF-16 input is converted 8 code units at a time up to the next
+*   surrogate (or non-ASCII unit for 8-bit T's), with big-endian units swapped in the same pass.
+*   Other characters are decoded one at a time and written with writechar().
+*/
+template <typename T>
+class text_decoder
+{
+public:
+
+    /**
+    *   \brief                Constructor.
+    *   \param  encoding [in] The encoding of the bytes, or TEXT_ENCODING_UNKNOWN to detect it.
+    */
+    explicit text_decoder(TEXT_ENCODING encoding = TEXT_ENCODING_UNKNOWN)
+        : requestedEncoding(encoding), currentEncoding(encoding), pendingCount(0), atStart(true)
+    {
+    }
+
+
+    /**
+    *   \brief  Retrieves the encoding being decoded. This is TEXT_ENCODING_UNKNOWN until it has been detected.
+    */
+    TEXT_ENCODING encoding() const
+    {
+        return this->currentEncoding;
+    }
+
+    /**
+    *   \brief  Gets ready for a new stream, forgetting anything held over from the last chunk.
+    */
+    void reset()
+    {
+        this->currentEncoding = this->requestedEncoding;
+        this->pendingCount    = 0;
+        this->atStart         = true;
+    }
+
+
+    /**
+    *   \brief                Decodes a chunk of bytes.
+    *   \param  data   [in]   The bytes.
+    *   \param  size   [in]   The number of bytes.
+    *   \param  output [out]  The list that the decoded T's are appended to.
+    */
+    void decode(const void *data, size_t size, std::vector<T> &output)
+    {
+        assert(data != NULL || size == 0);
+
+        const unsigned char *src = (const unsigned char *)data;
+        const unsigned char *end = src + size;
+
+        if (this->atStart)
+        {
+            // Hold on until there's enough to tell whether or not there's a BOM.
+            if (this->pendingCount + size < 4)
+            {
+                this->_hold(src, end);
+                return;
+            }
+
+            this->_start(src, end);
+        }
+
+        this->_decode(src, end, output);
+    }
+
+    /**
+    *   \brief                Finishes the stream, then resets the decoder.
+    *   \param  output [out]  The list that the decoded T's are appended to.
+    *
+    *   \remarks
+    *       A character that was cut off at the end of the stream becomes a single U+FFFD.
+    */
+    void finish(std::vector<T> &output)
+    {
+        const unsigned char *src = NULL;
+        if (this->atStart)
+        {
+            this->_start(src, src);
+        }
+
+        if (this->pendingCount > 0)
+        {
+            const unsigned char *pending_start = this->pending;
+            const unsigned char *pending_end   = this->pending + this->pendingCount;
+            while (pending_start < pending_end)
+            {
+                char32_t ch;
+                if (!_decodechar(this->currentEncoding, pending_start, pending_end, ch))
+                {
+                    ch = UNI_REPLACEMENT_CHAR;
+                    pending_start = pending_end;
+                }
+
+                this->_append(output, ch);
+            }
+        }
+
+        this->reset();
+    }
+
+
+
+private:
+
+    // Adds bytes to the ones held over from the last chunk.
+    void _hold(const unsigned char *src, const unsigned char *end)
+    {
+        assert(this->pendingCount + (size_t)(end - src) <= sizeof(this->pending));
+
+        if (src != end)
+        {
+            memcpy(this->pending + this->pendingCount, src, (size_t)(end - src));
+            this->pendingCount += (size_t)(end - src);
+        }
+    }
+
+    // Settles the encoding and skips the BOM. The first bytes of the stream are what's held over,
+    // followed by [src, end).
+    void _start(const unsigned char *&src, const unsigned char *end)
+    {
+        const unsigned char *head = src;
+        size_t head_size = (size_t)(end - src);
+
+        // Bytes held over from earlier chunks are joined up with as much of this one as
+        // detectencoding() looks at, so it sees the same bytes as it would for a single chunk.
+        unsigned char joined[4096];
+        if (this->pendingCount > 0)
+        {
+            size_t extra = sizeof(joined) - this->pendingCount;
+            if (extra > head_size)
+            {
+                extra = head_size;
+            }
+
+            memcpy(joined, this->pending, this->pendingCount);
+            if (extra > 0)
+            {
+                memcpy(joined + this->pendingCount, src, extra);
+            }
+
+            head = joined;
+            head_size = this->pendingCount + extra;
+        }
+
+        if (this->currentEncoding == TEXT_ENCODING_UNKNOWN)
+        {
+            this->currentEncoding = detectencoding(head, head_size);
+        }
+
+        size_t bom_size;
+        const unsigned char *bom = _encodingbom(this->currentEncoding, bom_size);
+        if (head_size >= bom_size && memcmp(head, bom, bom_size) == 0)
+        {
+            if (bom_size <= this->pendingCount)
+            {
+                memmove(this->pending, this->pending + bom_size, this->pendingCount - bom_size);
+                this->pendingCount -= bom_size;
+            }
+            else
+            {
+                src += bom_size - this->pendingCount;
+                this->pendingCount = 0;
+            }
+        }
+
+        this->atStart = false;
+    }
+
+    void _append(std::vector<T> &output, char32_t ch)
+    {
+        T units[4];
+        T *units_end = units;
+        writechar(units_end, ch);
+
+        output.insert(output.end(), units, units_end);
+    }
+
+    void _decode(const unsigned char *src, const unsigned char *end, std::vector<T> &output)
+    {
+        // Finish the character that was cut off at the end of the last chunk. A character is at
+        // most four bytes, so the first four bytes of this chunk are enough.
+        while (this->pendingCount > 0)
+        {
+            unsigned char joined[8];
+            size_t extra = ((size_t)(end - src) < 4) ? (size_t)(end - src) : 4;
+            memcpy(joined, this->pending, this->pendingCount);
+            if (extra > 0)
+            {
+                memcpy(joined + this->pendingCount, src, extra);
+            }
+
+            const unsigned char *temp = joined;
+            char32_t ch;
+            if (!_decodechar(this->currentEncoding, temp, joined + this->pendingCount + extra, ch))
+            {
+                // Still not enough, so the whole chunk has been used up.
+                this->_hold(src, end);
+                return;
+            }
+
+            this->_append(output, ch);
+
+            size_t used = (size_t)(temp - joined);
+            if (used >= this->pendingCount)
+            {
+                src += used - this->pendingCount;
+                this->pendingCount = 0;
+            }
+            else
+            {
+                // Only part of what was held over made up the character.
+                memmove(this->pending, this->pending + used, this->pendingCount - used);
+                this->pendingCount -= used;
+            }
+        }
+
+        // The output is grown a slice at a time, with room for the most T's the slice could
+        // decode to. That's three for each byte when an invalid UTF-8 byte becomes U+FFFD in
+        // UTF-8, plus the character that straddles the end of the slice.
+        const size_t slice_size = 65536;
+        const size_t units_per_byte = (sizeof(T) == 1) ? 3 : 1;
+
+        while (src < end)
+        {
+            const unsigned char *stop = ((size_t)(end - src) < slice_size) ? end : src + slice_size;
+
+            size_t old_size = output.size();
+            output.resize(old_size + (size_t)(stop - src) * units_per_byte + 4);
+
+            T *dest = &output[old_size];
+            bool complete = (this->currentEncoding == TEXT_ENCODING_UTF8) ? this->_decodeutf8run(src, stop, end, dest) : this->_decoderun(src, stop, end, dest);
+
+            output.resize((size_t)(dest - &output[0]));
+
+            if (!complete)
+            {
+                this->_hold(src, end);
+                return;
+            }
+        }
+    }
+
+    // Decodes the characters starting in [src, stop). The last one can carry on up to 'end'.
+    // Returns false if a character is cut off by 'end'. The pointers are copied into locals for the
+    // loop, since writes through 'dest' could otherwise alias them.
+    bool _decodeutf8run(const unsigned char *&src, const unsigned char *stop, const unsigned char *end, T *&dest)
+    {
+        const unsigned char *next = src;
+        T *out = dest;
+        bool complete = true;
+
+        while (next < stop)
+        {
+            if (*next < 0x80)
+            {
+                size_t count = _widenascii(next, stop, out);
+                next += count;
+                out  += count;
+                continue;
+            }
+
+            char32_t ch;
+            if (!_decodeutf8(next, end, ch))
+            {
+                complete = false;
+                break;
+            }
+
+            writechar(out, ch);
+        }
+
+        src  = next;
+        dest = out;
+        return complete;
+    }
+
+    // UTF-16 gets the same treatment as ASCII in UTF-8: runs of units that don't need decoding are
+    // converted 8 at a time, byte swapping included.
+    bool _decoderun(const unsigned char *&src, const unsigned char *stop, const unsigned char *end, T *&dest)
+    {
+        const TEXT_ENCODING encoding = this->currentEncoding;
+        const bool utf16 = (encoding == TEXT_ENCODING_UTF16LE || encoding == TEXT_ENCODING_UTF16BE);
+        const bool big_endian = (encoding == TEXT_ENCODING_UTF16BE);
+
+        const unsigned char *next = src;
+        T *out = dest;
+        bool complete = true;
+
+        while (next < stop)
+        {
+            if (utf16)
+            {
+                size_t count = _widenutf16(next, stop, big_endian, out);
+                if (count > 0)
+                {
+                    next += count;
+                    out  += count / 2;
+                    continue;
+                }
+            }
+
+            char32_t ch;
+            if (!_decodechar(encoding, next, end, ch))
+            {
+                complete = false;
+                break;
+            }
+
+            if (ch < 0x80)
+            {
+                *out++ = (T)ch;
+            }
+            else
+            {
+                writechar(out, ch);
+            }
+        }
+
+        src  = next;
+        dest = out;
+        return complete;
+    }
+
+
+    /// The encoding given to the constructor.
+    TEXT_ENCODING requestedEncoding;
+
+    /// The encoding being decoded.
+    TEXT_ENCODING currentEncoding;
+
+    /// The bytes of a character that was cut off at the end of the last chunk. At the start of
+    /// the stream this is also what's been given so far, while waiting to check for a BOM.
+    unsigned char pending[4];
+    size_t pendingCount;
+
+    /// Whether or not the BOM still needs checking for.
+    bool atStart;
+};
+
+}
+
+#endif // DRSL_TEXT_DECODER
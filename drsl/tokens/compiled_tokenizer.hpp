@@ -0,0 +1,1207 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+//
+// A tokenizer that produces the same tokens as nexttoken() (see compile() for the two corner cases
+// where it doesn't), but which turns the TOKEN_OPTIONS into lookup tables once, up front, instead of
+// re-examining the option strings for every character.
+//
+// Every ASCII code unit is given a class, where two code units are in the same class if they behave
+// the same way in every state. The state machine is then a table indexed by the current state and
+// the class of the next code unit, which gives the action to take. Anything outside of ASCII goes
+// down a slower path which decodes the full character.
+
+#ifndef DRSL_TOKENS_COMPILED_TOKENIZER
+#define DRSL_TOKENS_COMPILED_TOKENIZER
+
+namespace drsl
+{
+
+template <typename T>
+class compiled_tokenizer
+{
+public:
+
+    /**
+    *   \brief  Default constructor.
+    *
+    *   \remarks
+    *       The tokenizer behaves the same as nexttoken() with NULL options until compile() is called.
+    */
+    compiled_tokenizer()
+    {
+        this->compile(NULL);
+    }
+
+    /**
+    *   \brief               Constructor.
+    *   \param  options [in] The options to compile. Can be NULL.
+    */
+    explicit compiled_tokenizer(const TOKEN_OPTIONS<T> *options)
+    {
+        this->compile(options);
+    }
+
+
+    /**
+    *   \brief               Builds the lookup tables for the specified options.
+    *   \param  options [in] The options to compile. Can be NULL.
+    *
+    *   \remarks
+    *       The option strings are copied, so they don't need to stay around after this returns.
+    *       \par
+    *       Empty entries in the symbol group and ignore block start lists (caused by two spaces in a
+    *       row) are skipped. With nexttoken() such an entry matches everywhere as an empty token.
+    *       \par
+    *       Ending ignore block strings only match when every code unit matches. nexttoken() can
+    *       match one where a multi-unit character lines up with its last code units ("#é" for "#!"),
+    *       which leaves the string part way through that character and stops tokenizing.
+    */
+    void compile(const TOKEN_OPTIONS<T> *options)
+    {
+        this->storage.clear();
+        this->groups.clear();
+        this->ignoreStarts.clear();
+        this->ignoreEnds.clear();
+        this->endCandidates.clear();
+        this->endCandidateRanges.clear();
+        this->quotes.clear();
+        this->escapeCharacter = '\0';
+        this->keywordTable.clear();
+
+        if (options != NULL)
+        {
+            this->escapeCharacter = options->escapeCharacter;
+
+            this->_addentries(options->symbolGroups, this->groups);
+            this->_addentries(options->ignoreBlockStart, this->ignoreStarts);
+            this->_addentries(options->ignoreBlockEnd, this->ignoreEnds);
+            this->keywordTable.build(options->keywords);
+
+            if (options->quotes != NULL)
+            {
+                const T *temp = options->quotes;
+
+                char32_t ch;
+                while ((ch = nextchar(temp)) != '\0')
+                {
+                    this->quotes.push_back(ch);
+                }
+            }
+        }
+
+        this->_buildbuckets(this->groups, this->groupOrder, this->groupBuckets);
+        this->_buildbuckets(this->ignoreStarts, this->ignoreStartOrder, this->ignoreStartBuckets);
+
+
+        // The ending strings that are checked for an ignore block are those at the same index as any
+        // starting string that begins with the one that opened the block.
+        for (size_t iStart = 0; iStart < this->ignoreStarts.size(); ++iStart)
+        {
+            _candidate_range range;
+            range.first = this->endCandidates.size();
+            range.anyPosition = false;
+            memset(range.firstUnits, 0, sizeof(range.firstUnits));
+            range.firstUnitsOther = false;
+
+            const _entry &start = this->ignoreStarts[iStart];
+            for (size_t iOther = 0; iOther < this->ignoreStarts.size(); ++iOther)
+            {
+                const _entry &other = this->ignoreStarts[iOther];
+                if (iOther >= this->ignoreEnds.size() || other.length < start.length || !this->_entryequal(other, start))
+                {
+                    continue;
+                }
+
+                const _entry &end = this->ignoreEnds[iOther];
+                this->endCandidates.push_back(iOther);
+
+                if (end.length == 0)
+                {
+                    range.anyPosition = true;
+                }
+                else
+                {
+                    char32_t first = _codeunit(this->storage[end.offset]);
+                    if (first < 128)
+                    {
+                        range.firstUnits[first] = true;
+                    }
+                    else
+                    {
+                        range.firstUnitsOther = true;
+                    }
+                }
+            }
+
+            range.last = this->endCandidates.size();
+            this->endCandidateRanges.push_back(range);
+        }
+
+
+        // Work out what each ASCII code unit does in each state, and then group code units that
+        // always do the same thing into classes.
+        unsigned char actions[129][STATE_COUNT];
+        for (char32_t unit = 0; unit < 128; ++unit)
+        {
+            bool alnum = (unit >= 'a' && unit <= 'z') || (unit >= 'A' && unit <= 'Z') || unit == '_' || (unit >= '0' && unit <= '9');
+
+            unsigned char start_action;
+            if (unit == '\0')
+            {
+                start_action = ACTION_EOF;
+            }
+            else if (unit <= ' ')
+            {
+                start_action = (unit == '\n') ? ACTION_NEWLINE : ACTION_SKIP;
+            }
+            else if (unit >= '0' && unit <= '9')
+            {
+                start_action = ACTION_BEGIN_NUMBER;
+            }
+            else if (alnum)
+            {
+                start_action = ACTION_BEGIN_WORD;
+            }
+            else if (this->_isquote(unit))
+            {
+                start_action = ACTION_BEGIN_QUOTE;
+            }
+            else if (unit == '-')
+            {
+                start_action = ACTION_BEGIN_MINUS;
+            }
+            else if (this->groupBuckets[unit] != this->groupBuckets[unit + 1] || this->ignoreStartBuckets[unit] != this->ignoreStartBuckets[unit + 1])
+            {
+                start_action = ACTION_BEGIN_SPECIAL;
+            }
+            else
+            {
+                start_action = ACTION_BEGIN_SYMBOL;
+            }
+
+            actions[unit][STATE_START]    = start_action;
+            actions[unit][STATE_WORD]     = alnum ? ACTION_CONTINUE : ACTION_END;
+            actions[unit][STATE_NUMBER]   = alnum ? ACTION_CONTINUE : ((unit == '.') ? ACTION_DOT : ACTION_END);
+            actions[unit][STATE_FRACTION] = alnum ? ACTION_CONTINUE : ACTION_END;
+        }
+
+        // Everything outside of ASCII.
+        actions[128][STATE_START]    = ACTION_BEGIN_OTHER;
+        actions[128][STATE_WORD]     = ACTION_END;
+        actions[128][STATE_NUMBER]   = ACTION_END;
+        actions[128][STATE_FRACTION] = ACTION_END;
+
+        unsigned int class_count = 0;
+        for (unsigned int unit = 0; unit < 129; ++unit)
+        {
+            unsigned int unit_class = 0;
+            while (unit_class < class_count && memcmp(actions[unit], actions[this->classRepresentative[unit_class]], STATE_COUNT) != 0)
+            {
+                ++unit_class;
+            }
+
+            if (unit_class == class_count)
+            {
+                this->classRepresentative[class_count] = (unsigned char)unit;
+                for (unsigned int iState = 0; iState < STATE_COUNT; ++iState)
+                {
+                    this->transitions[iState][class_count] = actions[unit][iState];
+                }
+
+                class_count += 1;
+            }
+
+            if (unit < 128)
+            {
+                this->classes[unit] = (unsigned char)unit_class;
+            }
+            else
+            {
+                this->otherClass = (unsigned char)unit_class;
+            }
+        }
+
+
+        // Ending strings are only looked for at the code units that are checkpoints (see
+        // _skipignoreblock()), so that's all that needs stopping at inside a block.
+        for (size_t iRange = 0; iRange < this->endCandidateRanges.size(); ++iRange)
+        {
+            _candidate_range &range = this->endCandidateRanges[iRange];
+            range.skipFast = !range.anyPosition && !range.firstUnitsOther;
+            range.skipTo   = 0;
+
+            for (char32_t unit = 1; unit < 128 && range.skipFast; ++unit)
+            {
+                if (range.firstUnits[unit] && this->_ischeckpoint(unit))
+                {
+                    range.skipFast = (range.skipTo == 0);
+                    range.skipTo   = (T)unit;
+                }
+            }
+        }
+    }
+
+
+    /**
+    *   \brief                      Retrieves the next token and moves the pointer to the end of that token.
+    *   \param  str       [in, out] The string to retrieve the next token from.
+    *   \param  token     [out]     The reference string that will recieve the next token.
+    *   \param  line      [out]     The integer that will recieve the number of new lines between \c str and the end of the token.
+    *   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+    *   \return                     True if a token is retrieved; false otherwise.
+    *
+    *   \remarks
+    *       This behaves exactly like nexttoken() with the options that were compiled. The only
+    *       difference is that \c strLength is always respected, whereas nexttoken() can look one
+    *       character past it.
+    *       \par
+    *       When the function returns false, the input string is not modified.
+    */
+    bool nexttoken(T *&str, reference_string<T> &token, size_t *line, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        size_t line_count = 0;
+        const T *limit = (strLength == (size_t)-1) ? NULL : str + strLength;
+
+        const T *temp = str;
+        const T *token_start;
+        const T *token_end;
+        if (!this->_next(temp, limit, token_start, token_end, line_count))
+        {
+            if (line != NULL)
+            {
+                *line = line_count;
+            }
+
+            return false;
+        }
+
+        // The token is always inside the input string, so this doesn't lose any constness.
+        token.start = str + (token_start - str);
+        token.end   = str + (token_end - str);
+        str = token.end;
+
+        if (line != NULL)
+        {
+            *line = line_count;
+        }
+
+        return true;
+    }
+
+    bool nexttoken(reference_string<T> &str, reference_string<T> &token, size_t *line) const
+    {
+        return this->nexttoken(str.start, token, line, length(str));
+    }
+
+    /**
+    *   \brief                      Retrieves the next token and its keyword ID, and moves the pointer to the end of that token.
+    *   \param  str       [in, out] The string to retrieve the next token from.
+    *   \param  token     [out]     The reference string that will recieve the next token.
+    *   \param  line      [out]     The integer that will recieve the number of new lines between \c str and the end of the token.
+    *   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+    *   \param  keyword   [out]     Receives the keyword ID of the token, or -1 if it isn't a keyword. See keyword().
+    *   \return                     True if a token is retrieved; false otherwise.
+    */
+    bool nexttoken(T *&str, reference_string<T> &token, size_t *line, size_t strLength, int *keyword) const
+    {
+        if (!this->nexttoken(str, token, line, strLength))
+        {
+            return false;
+        }
+
+        if (keyword != NULL)
+        {
+            *keyword = this->keyword(token);
+        }
+
+        return true;
+    }
+
+
+    /**
+    *   \brief                 Extracts a list of tokens from the specified string.
+    *   \param  str       [in] The string to tokenise.
+    *   \param  tokens    [in] A reference to the list that will recieve the tokens.
+    *   \param  lines     [in] A reference to the list that will recieve the lines of each token. Can be NULL.
+    *   \param  strLength [in] The length in T's of the input string, not including the null terminator.
+    *
+    *   \remarks
+    *       This is the same as extracttokens(), including the values placed in \c lines, which are the
+    *       number of new lines since the end of the previous token.
+    */
+    void extracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines, size_t strLength = -1) const
+    {
+        const T *limit = (strLength == (size_t)-1) ? NULL : str + strLength;
+
+        const T *temp = str;
+        const T *token_start;
+        const T *token_end;
+        size_t line_count = 0;
+        while (this->_next(temp, limit, token_start, token_end, line_count))
+        {
+            reference_string<T> token;
+            token.start = str + (token_start - str);
+            token.end   = str + (token_end - str);
+            tokens.push_back(token);
+
+            if (lines != NULL)
+            {
+                lines->push_back(line_count);
+            }
+
+            line_count = 0;
+        }
+    }
+
+
+    /**
+    *   \brief                 Extracts a list of tokens from the specified string, along with the keyword ID of each one.
+    *   \param  str       [in] The string to tokenise.
+    *   \param  tokens    [in] A reference to the list that will recieve the tokens.
+    *   \param  lines     [in] A reference to the list that will recieve the lines of each token. Can be NULL.
+    *   \param  keywords  [in] A reference to the list that will recieve the keyword ID of each token, or -1 for tokens that aren't keywords. Can be NULL.
+    *   \param  strLength [in] The length in T's of the input string, not including the null terminator.
+    */
+    void extracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines, std::vector<int> *keywords, size_t strLength = -1) const
+    {
+        size_t first_token = tokens.size();
+        this->extracttokens(str, tokens, lines, strLength);
+
+        if (keywords != NULL)
+        {
+            for (size_t i = first_token; i < tokens.size(); ++i)
+            {
+                keywords->push_back(this->keyword(tokens[i]));
+            }
+        }
+    }
+
+
+    /**
+    *   \brief             Retrieves the keyword ID of a token returned by this tokenizer.
+    *   \param  token [in] The token.
+    *   \return            The position of the token in the \c keywords option list, or -1 if the token is not a word or not a keyword.
+    *
+    *   \remarks
+    *       Only word tokens are looked up, so a keyword that isn't a word never matches. The
+    *       keywords are compiled into a perfect hash (see keyword_table), so this costs one hash
+    *       and at most one comparison, and most words are rejected on their length or first
+    *       character without being hashed.
+    */
+    int keyword(const reference_string<T> &token) const
+    {
+        if (token.start == token.end)
+        {
+            return -1;
+        }
+
+        char32_t first = _codeunit(*token.start);
+        if (first >= 128 || this->transitions[STATE_START][this->classes[first]] != ACTION_BEGIN_WORD)
+        {
+            return -1;
+        }
+
+        return this->keywordTable.find(token.start, token.end);
+    }
+
+
+    /**
+    *   \brief  Retrieves the number of T's past a position that can affect how the string at that position is tokenised.
+    *
+    *   \remarks
+    *       If a string is cut short, everything decided at least this many T's before the cut is the
+    *       same as it would have been for the full string. token_stream stops scanning each chunk
+    *       this far from its end, and carries on from there with the next chunk.
+    */
+    size_t lookahead() const
+    {
+        // The longest character is 4 UTF-8 code units, and "-1" and "1.5" need to see one more.
+        size_t longest = 4;
+        for (size_t i = 0; i < this->groups.size(); ++i)
+        {
+            longest = (this->groups[i].length > longest) ? this->groups[i].length : longest;
+        }
+        for (size_t i = 0; i < this->ignoreStarts.size(); ++i)
+        {
+            longest = (this->ignoreStarts[i].length > longest) ? this->ignoreStarts[i].length : longest;
+        }
+        for (size_t i = 0; i < this->ignoreEnds.size(); ++i)
+        {
+            longest = (this->ignoreEnds[i].length > longest) ? this->ignoreEnds[i].length : longest;
+        }
+
+        return longest + 1;
+    }
+
+
+
+private:
+
+    // token_stream carries a scan over from one chunk to the next with _scan().
+    template <typename U> friend class token_stream;
+
+    /// The states that are driven by the transition table. Quotes and ignore blocks have their own
+    /// loops, and only have states so that a scan that stops inside one can carry on later.
+    enum
+    {
+        STATE_START,
+        STATE_WORD,
+        STATE_NUMBER,
+        STATE_FRACTION,
+        STATE_COUNT,
+        STATE_QUOTE = STATE_COUNT,
+        STATE_IGNORE
+    };
+
+    /// The actions stored in the transition table.
+    enum
+    {
+        ACTION_EOF,             // The end of the string.
+        ACTION_SKIP,            // White space before a token.
+        ACTION_NEWLINE,         // A new line before a token.
+        ACTION_BEGIN_WORD,
+        ACTION_BEGIN_NUMBER,
+        ACTION_BEGIN_MINUS,     // A '-', which is either a number or a symbol on its own.
+        ACTION_BEGIN_QUOTE,
+        ACTION_BEGIN_SYMBOL,    // A symbol that is always a single character token.
+        ACTION_BEGIN_SPECIAL,   // A symbol that might start a symbol group or ignore block.
+        ACTION_BEGIN_OTHER,     // Anything outside of ASCII, which needs decoding first.
+        ACTION_CONTINUE,        // The code unit is part of the current token.
+        ACTION_END,             // The code unit is not part of the current token.
+        ACTION_DOT              // A '.' in a number, which is part of the number if a digit follows it.
+    };
+
+    /// An entry in one of the space separated option lists, stored in 'storage'.
+    struct _entry
+    {
+        size_t offset;
+        size_t length;
+    };
+
+    /// The ending strings to check for an ignore block opened by a particular starting string.
+    struct _candidate_range
+    {
+        /// The range of 'endCandidates' to check.
+        size_t first;
+        size_t last;
+
+        /// Whether or not one of the ending strings is empty, meaning every position needs checking.
+        bool anyPosition;
+
+        /// The ASCII code units that at least one of the ending strings starts with.
+        bool firstUnits[128];
+
+        /// Whether or not at least one of the ending strings starts with something outside of ASCII.
+        bool firstUnitsOther;
+
+        /// Whether or not the block can be skipped with _skiptounit(), which is the case when there is
+        /// at most one code unit that an ending string can be found at. That unit is 'skipTo', or 0 if
+        /// there isn't one.
+        bool skipFast;
+        T skipTo;
+    };
+
+    /// Where a scan of part of a string stopped, so that it can carry on with the rest of the
+    /// string in another buffer. See _scan().
+    struct _scan_state
+    {
+        /// One of the STATE_* values.
+        unsigned int state;
+
+        /// The starting string of the last ignore block skipped since the last token. For
+        /// STATE_IGNORE, this is the block the scan is inside of. See _scanquote().
+        size_t lastIgnoreStart;
+
+        /// For STATE_QUOTE, the quote character and the character before where the scan stopped.
+        char32_t quoteCharacter;
+        char32_t prevCharacter;
+
+        /// The number of new lines since the end of the last token.
+        size_t lineCount;
+    };
+
+
+    void _addentries(const T *list, std::vector<_entry> &entries)
+    {
+        if (list == NULL)
+        {
+            return;
+        }
+
+        _entry entry;
+        entry.offset = this->storage.size();
+        entry.length = 0;
+
+        for ( ; *list != '\0'; ++list)
+        {
+            if (*list == ' ')
+            {
+                entries.push_back(entry);
+
+                entry.offset = this->storage.size();
+                entry.length = 0;
+            }
+            else
+            {
+                this->storage.push_back(*list);
+                entry.length += 1;
+            }
+        }
+
+        entries.push_back(entry);
+    }
+
+    // Sorts the non-empty entries by their first code unit so only the ones that can match at a
+    // particular position need to be looked at. Entries with the same first code unit stay in list
+    // order, because the first one in the list wins.
+    void _buildbuckets(const std::vector<_entry> &entries, std::vector<size_t> &order, size_t (&buckets)[130])
+    {
+        memset(buckets, 0, sizeof(buckets));
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (entries[i].length > 0)
+            {
+                buckets[_bucket(this->storage[entries[i].offset]) + 1] += 1;
+            }
+        }
+
+        for (size_t i = 1; i < 130; ++i)
+        {
+            buckets[i] += buckets[i - 1];
+        }
+
+        size_t next[129];
+        memcpy(next, buckets, sizeof(next));
+
+        order.resize(buckets[129]);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (entries[i].length > 0)
+            {
+                order[next[_bucket(this->storage[entries[i].offset])]++] = i;
+            }
+        }
+    }
+
+    static size_t _bucket(T unit)
+    {
+        char32_t value = _codeunit(unit);
+        return (value < 128) ? (size_t)value : 128;
+    }
+
+    bool _entryequal(const _entry &a, const _entry &b) const
+    {
+        size_t count = (a.length < b.length) ? a.length : b.length;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (this->storage[a.offset + i] != this->storage[b.offset + i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool _isquote(char32_t ch) const
+    {
+        for (size_t i = 0; i < this->quotes.size(); ++i)
+        {
+            if (this->quotes[i] == ch)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Determines if the string at 'str' starts with the specified entry.
+    bool _startswith(const T *str, const T *limit, const _entry &entry) const
+    {
+        if (limit != NULL && (size_t)(limit - str) < entry.length)
+        {
+            return false;
+        }
+
+        const T *entry_str = &this->storage[0] + entry.offset;
+        for (size_t i = 0; i < entry.length; ++i)
+        {
+            // The null terminator never matches since entries can't contain it.
+            if (str[i] != entry_str[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Finds the first entry in list order that 'str' starts with. Returns the entry's index, or -1.
+    size_t _findentry(const T *str, const T *limit, const std::vector<_entry> &entries, const std::vector<size_t> &order, const size_t (&buckets)[130]) const
+    {
+        size_t bucket = _bucket(*str);
+        for (size_t i = buckets[bucket]; i < buckets[bucket + 1]; ++i)
+        {
+            if (this->_startswith(str, limit, entries[order[i]]))
+            {
+                return order[i];
+            }
+        }
+
+        return (size_t)-1;
+    }
+
+    // Checks for the end of an ignore block at 'str'. Returns the length of the ending string, or -1.
+    size_t _matchignoreend(const T *str, const T *limit, const _candidate_range &range) const
+    {
+        for (size_t i = range.first; i < range.last; ++i)
+        {
+            const _entry &end = this->ignoreEnds[this->endCandidates[i]];
+            if (this->_startswith(str, limit, end))
+            {
+                return end.length;
+            }
+        }
+
+        return (size_t)-1;
+    }
+
+    // Determines whether or not an ending ignore block string can start at an ASCII code unit inside a block.
+    bool _ischeckpoint(char32_t unit) const
+    {
+        unsigned char start_action = this->transitions[STATE_START][this->classes[unit]];
+        return (unit == '\n') || (start_action != ACTION_SKIP && start_action != ACTION_BEGIN_WORD && start_action != ACTION_BEGIN_NUMBER);
+    }
+
+    static bool _atend(const T *str, const T *limit)
+    {
+        return str == limit || *str == '\0';
+    }
+
+    // Determines if a scan has reached the part of the string where it can't decide anything yet.
+    // See _scan().
+    static bool _atstop(const T *str, const T *limit, const T *stop)
+    {
+        return stop != limit && str >= stop;
+    }
+
+    // Retrieves the state a scan is in at the start of a string.
+    static _scan_state _newscan()
+    {
+        _scan_state scan;
+        scan.state           = STATE_START;
+        scan.lastIgnoreStart = (size_t)-1;
+        scan.quoteCharacter  = '\0';
+        scan.prevCharacter   = '\0';
+        scan.lineCount       = 0;
+
+        return scan;
+    }
+
+    static bool _isdigitunit(const T *str, const T *limit)
+    {
+        return !_atend(str, limit) && (char32_t)(_codeunit(*str) - '0') <= 9;
+    }
+
+    // Retrieves the number of code units in the character starting with the specified unit, going by the unit alone.
+    static size_t _unitsneeded(T unit)
+    {
+        char32_t value = _codeunit(unit);
+        if (sizeof(T) == 1)
+        {
+            return 1 + (size_t)g_trailingBytesForUTF8[value & 0xFF];
+        }
+
+        if (sizeof(T) == 2)
+        {
+            return (value >= 0xD800 && value <= 0xDBFF) ? 2 : 1;
+        }
+
+        return 1;
+    }
+
+    // Decodes the character at 'str', which is outside of ASCII. Returns 0 at the end of the string
+    // or if the character is invalid, in which case 'next' is left alone.
+    static char32_t _decode(const T *str, const T *limit, const T *&next)
+    {
+        // A character cut off by the limit is treated as invalid, without reading past the limit.
+        if (limit != NULL && (size_t)(limit - str) < _unitsneeded(*str))
+        {
+            return '\0';
+        }
+
+        const T *temp = str;
+        char32_t ch = nextchar(temp);
+        if (ch == '\0' || (limit != NULL && temp > limit))
+        {
+            return '\0';
+        }
+
+        next = temp;
+        return ch;
+    }
+
+
+    // Scans the rest of a quote. 'str' is just past the opening quote, or where the scan stopped
+    // last time, and 'prevCharacter' is the character before it. Returns 1 if the token was
+    // found, with 'str' moved to its end, or 0 if the quote was cancelled, with 'str' moved to
+    // where scanning continues. Returns -1 if 'stop' was reached, with 'scan' left in the quote.
+    //
+    // The cancelling replicates nexttoken(), which remembers the last ignore block it skipped in the
+    // same call and will end that block again at a new line, even inside a quote. When that happens
+    // the quote is dropped and the search for a token starts again after the new line.
+    int _scanquote(const T *&str, const T *limit, const T *stop, char32_t quoteCharacter, char32_t prevCharacter, size_t lastIgnoreStart, _scan_state &scan) const
+    {
+        while (!_atend(str, limit) && !_atstop(str, limit, stop))
+        {
+            char32_t ch = _codeunit(*str);
+            const T *next = str + 1;
+
+            if (ch >= 128)
+            {
+                ch = _decode(str, limit, next);
+                if (ch == '\0')
+                {
+                    break;
+                }
+            }
+
+            if (ch == '\n')
+            {
+                scan.lineCount += 1;
+
+                if (lastIgnoreStart != (size_t)-1 && this->_matchignoreend(str, limit, this->endCandidateRanges[lastIgnoreStart]) != (size_t)-1)
+                {
+                    str = next;
+                    return 0;
+                }
+            }
+            else if (ch == quoteCharacter && prevCharacter != this->escapeCharacter)
+            {
+                str = next;
+                return 1;
+            }
+
+            prevCharacter = ch;
+            str = next;
+        }
+
+        if (_atstop(str, limit, stop))
+        {
+            scan.state           = STATE_QUOTE;
+            scan.lastIgnoreStart = lastIgnoreStart;
+            scan.quoteCharacter  = quoteCharacter;
+            scan.prevCharacter   = prevCharacter;
+            return -1;
+        }
+
+        // An unclosed quote runs to the end of the string.
+        return 1;
+    }
+
+    // Skips over an ignore block. 'str' is just past the starting string, or where the scan
+    // stopped last time. Returns 1 at the end of the block and 0 if the end of the string was
+    // reached first. Returns -1 if 'stop' was reached, with 'scan' left in the block.
+    int _skipignoreblock(const T *&str, const T *limit, const T *stop, size_t startIndex, _scan_state &scan) const
+    {
+        const _candidate_range &range = this->endCandidateRanges[startIndex];
+
+        // Ending strings are only looked for at new lines and symbols.
+        while (!_atend(str, limit) && !_atstop(str, limit, stop))
+        {
+            if (range.skipFast)
+            {
+                // Jump straight to the next place an ending string could start.
+                str = _skiptounit(str, stop, range.skipTo, scan.lineCount);
+                if (_atend(str, limit) || _atstop(str, limit, stop))
+                {
+                    break;
+                }
+            }
+
+            char32_t unit = _codeunit(*str);
+            if (unit < 128)
+            {
+                bool checkpoint = this->_ischeckpoint(unit);
+
+                if (unit == '\n')
+                {
+                    scan.lineCount += 1;
+                }
+
+                if (checkpoint && (range.anyPosition || range.firstUnits[unit]))
+                {
+                    size_t end_length = this->_matchignoreend(str, limit, range);
+                    if (end_length != (size_t)-1)
+                    {
+                        // At a new line, scanning continues after the new line whatever the length of the ending string.
+                        str += (unit == '\n') ? 1 : end_length;
+                        return 1;
+                    }
+                }
+
+                str += 1;
+            }
+            else
+            {
+                const T *next = str;
+                if (_decode(str, limit, next) == '\0')
+                {
+                    break;
+                }
+
+                if (range.anyPosition || range.firstUnitsOther)
+                {
+                    size_t end_length = this->_matchignoreend(str, limit, range);
+                    if (end_length != (size_t)-1)
+                    {
+                        str += end_length;
+                        return 1;
+                    }
+                }
+
+                str = next;
+            }
+        }
+
+        if (_atstop(str, limit, stop))
+        {
+            scan.state           = STATE_IGNORE;
+            scan.lastIgnoreStart = startIndex;
+            return -1;
+        }
+
+        return 0;
+    }
+
+    // Starts a token with a symbol that might be the start of a symbol group or ignore block.
+    // Returns 1 if a token was found, 0 if an ignore block was skipped, -1 at the end of the string
+    // and -2 if 'stop' was reached inside an ignore block.
+    int _beginspecial(const T *&str, const T *limit, const T *stop, const T *symbolEnd, const T *&tokenStart, const T *&tokenEnd, size_t &lastIgnoreStart, _scan_state &scan) const
+    {
+        size_t group = this->_findentry(str, limit, this->groups, this->groupOrder, this->groupBuckets);
+        if (group != (size_t)-1)
+        {
+            tokenStart = str;
+            tokenEnd   = str + this->groups[group].length;
+            return 1;
+        }
+
+        size_t ignore_start = this->_findentry(str, limit, this->ignoreStarts, this->ignoreStartOrder, this->ignoreStartBuckets);
+        if (ignore_start != (size_t)-1)
+        {
+            str += this->ignoreStarts[ignore_start].length;
+            lastIgnoreStart = ignore_start;
+
+            int result = this->_skipignoreblock(str, limit, stop, ignore_start, scan);
+            return (result == 1) ? 0 : ((result == 0) ? -1 : -2);
+        }
+
+        tokenStart = str;
+        tokenEnd   = symbolEnd;
+        return 1;
+    }
+
+
+    // The main loop. On success, 'str' is moved to the end of the token.
+    bool _next(const T *&str, const T *limit, const T *&tokenStart, const T *&tokenEnd, size_t &lineCount) const
+    {
+        _scan_state scan = _newscan();
+        scan.lineCount = lineCount;
+
+        bool found = (this->_scan(str, limit, limit, tokenStart, tokenEnd, scan) == 1);
+
+        lineCount = scan.lineCount;
+        return found;
+    }
+
+    // Looks for the next token, carrying on from 'scan'. Returns 1 if a token was found, in which
+    // case 'str' is moved to the end of the token, and 0 at the end of the string.
+    //
+    // When the string is only part of the input, 'stop' is the point past which more of the input
+    // could change what's decided (see lookahead()). Nothing is decided at or past it. Reaching it
+    // returns -1, with 'str' moved to where the scan got to and 'scan' saying what it was in the
+    // middle of. For a word, number or quote, the token so far starts at 'tokenStart', which needs
+    // to be passed back in along with the rest of the input. When the string is complete, 'stop'
+    // is the same as 'limit'.
+    int _scan(const T *&str, const T *limit, const T *stop, const T *&tokenStart, const T *&tokenEnd, _scan_state &scan) const
+    {
+        const T *current = str;
+        unsigned int state = scan.state;
+
+        // The starting string of the last ignore block skipped since the last token. See _scanquote().
+        size_t last_ignore_start = scan.lastIgnoreStart;
+
+        // Carry on with a quote or ignore block that the scan stopped inside of last time.
+        if (state == STATE_QUOTE)
+        {
+            int result = this->_scanquote(current, limit, stop, scan.quoteCharacter, scan.prevCharacter, last_ignore_start, scan);
+            if (result != 0)
+            {
+                tokenEnd = current;
+                str = current;
+                return result;
+            }
+
+            state = STATE_START;
+        }
+        else if (state == STATE_IGNORE)
+        {
+            int result = this->_skipignoreblock(current, limit, stop, last_ignore_start, scan);
+            if (result != 1)
+            {
+                str = (result == -1) ? current : str;
+                return result;
+            }
+
+            state = STATE_START;
+        }
+
+        for (;;)
+        {
+            unsigned char action;
+            if (current == limit || _atstop(current, limit, stop))
+            {
+                if (stop != limit)
+                {
+                    scan.state           = state;
+                    scan.lastIgnoreStart = last_ignore_start;
+                    str = current;
+                    return -1;
+                }
+
+                action = (state == STATE_START) ? (unsigned char)ACTION_EOF : (unsigned char)ACTION_END;
+            }
+            else
+            {
+                char32_t unit = _codeunit(*current);
+                action = this->transitions[state][(unit < 128) ? this->classes[unit] : this->otherClass];
+            }
+
+            switch (action)
+            {
+            case ACTION_CONTINUE:
+                {
+                    // Most of the time is spent here inside words and numbers. Whatever the state,
+                    // the units that continue a token are exactly the letters and digits.
+                    current = _skipidentifier(current + 1, stop);
+                    break;
+                }
+
+            case ACTION_SKIP:
+                {
+                    current = _skipblanks(current + 1, stop);
+                    break;
+                }
+
+            case ACTION_NEWLINE:
+                {
+                    scan.lineCount += 1;
+                    current += 1;
+                    break;
+                }
+
+            case ACTION_BEGIN_WORD:
+                {
+                    tokenStart = current;
+                    state = STATE_WORD;
+                    current += 1;
+                    break;
+                }
+
+            case ACTION_BEGIN_NUMBER:
+                {
+                    tokenStart = current;
+                    state = STATE_NUMBER;
+                    current += 1;
+                    break;
+                }
+
+            case ACTION_BEGIN_MINUS:
+                {
+                    tokenStart = current;
+                    if (_isdigitunit(current + 1, limit))
+                    {
+                        state = STATE_NUMBER;
+                        current += 2;
+                        break;
+                    }
+
+                    tokenEnd = current + 1;
+                    str = tokenEnd;
+                    return 1;
+                }
+
+            case ACTION_BEGIN_QUOTE:
+                {
+                    tokenStart = current;
+                    current += 1;
+
+                    char32_t quote_ch = _codeunit(*tokenStart);
+                    int result = this->_scanquote(current, limit, stop, quote_ch, quote_ch, last_ignore_start, scan);
+                    if (result == 0)
+                    {
+                        break;
+                    }
+
+                    tokenEnd = current;
+                    str = current;
+                    return result;
+                }
+
+            case ACTION_BEGIN_SYMBOL:
+                {
+                    tokenStart = current;
+                    tokenEnd = current + 1;
+                    str = tokenEnd;
+                    return 1;
+                }
+
+            case ACTION_BEGIN_SPECIAL:
+                {
+                    int result = this->_beginspecial(current, limit, stop, current + 1, tokenStart, tokenEnd, last_ignore_start, scan);
+                    if (result == 1)
+                    {
+                        str = tokenEnd;
+                        return 1;
+                    }
+
+                    if (result == -1)
+                    {
+                        return 0;
+                    }
+
+                    if (result == -2)
+                    {
+                        str = current;
+                        return -1;
+                    }
+
+                    break;
+                }
+
+            case ACTION_BEGIN_OTHER:
+                {
+                    const T *next = current;
+                    char32_t ch = _decode(current, limit, next);
+                    if (ch == '\0')
+                    {
+                        return 0;
+                    }
+
+                    if (this->_isquote(ch))
+                    {
+                        tokenStart = current;
+                        current = next;
+
+                        int result = this->_scanquote(current, limit, stop, ch, ch, last_ignore_start, scan);
+                        if (result == 0)
+                        {
+                            break;
+                        }
+
+                        tokenEnd = current;
+                        str = current;
+                        return result;
+                    }
+
+                    int result = this->_beginspecial(current, limit, stop, next, tokenStart, tokenEnd, last_ignore_start, scan);
+                    if (result == 1)
+                    {
+                        str = tokenEnd;
+                        return 1;
+                    }
+
+                    if (result == -1)
+                    {
+                        return 0;
+                    }
+
+                    if (result == -2)
+                    {
+                        str = current;
+                        return -1;
+                    }
+
+                    break;
+                }
+
+            case ACTION_DOT:
+                {
+                    if (_isdigitunit(current + 1, limit))
+                    {
+                        state = STATE_FRACTION;
+                        current += 2;
+                        break;
+                    }
+
+                    tokenEnd = current;
+                    str = tokenEnd;
+                    return 1;
+                }
+
+            case ACTION_END:
+                {
+                    tokenEnd = current;
+                    str = tokenEnd;
+                    return 1;
+                }
+
+            case ACTION_EOF:
+            default:
+                {
+                    return 0;
+                }
+            }
+        }
+    }
+
+
+
+    /// The class of each ASCII code unit.
+    unsigned char classes[128];
+
+    /// The class of every code unit outside of ASCII.
+    unsigned char otherClass;
+
+    /// The action to take for each state and class.
+    unsigned char transitions[STATE_COUNT][129];
+
+    /// A code unit belonging to each class, used while building the tables.
+    unsigned char classRepresentative[129];
+
+    /// The characters of every entry in the option lists.
+    std::vector<T> storage;
+
+    /// The symbol groups, plus their indices sorted by first code unit and the start of each bucket.
+    std::vector<_entry> groups;
+    std::vector<size_t> groupOrder;
+    size_t groupBuckets[130];
+
+    /// The ignore block starting strings, sorted and bucketed in the same way as the symbol groups.
+    std::vector<_entry> ignoreStarts;
+    std::vector<size_t> ignoreStartOrder;
+    size_t ignoreStartBuckets[130];
+
+    /// The ignore block ending strings, in list order.
+    std::vector<_entry> ignoreEnds;
+
+    /// For each ignore block starting string, the ending strings to look for.
+    std::vector<size_t> endCandidates;
+    std::vector<_candidate_range> endCandidateRanges;
+
+    /// The quote characters.
+    std::vector<char32_t> quotes;
+
+    /// The escape character used inside quotes.
+    char32_t escapeCharacter;
+
+    /// The keywords that word tokens are tagged with.
+    keyword_table<T> keywordTable;
+};
+
+}
+
+#endif // DRSL_TOKENS_COMPILED_TOKENIZER
@@ -21,9 +21,12 @@ namespace drsl
 template <typename T>
 void extracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
 {
+    // Each call to nexttoken() needs to be given the length of what's left of the string, not the whole thing.
+    T *end = (strLength == (size_t)-1) ? NULL : str + strLength;
+
     reference_string<T> cur_token;
     size_t cur_line;
-    while (nexttoken(str, cur_token, &cur_line, options, strLength))
+    while (nexttoken(str, cur_token, &cur_line, options, (end == NULL) ? (size_t)-1 : ((str < end) ? (size_t)(end - str) : 0)))
     {
         tokens.push_back(cur_token);
 
@@ -40,6 +43,49 @@ void extracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vecto
 {
     extracttokens(str, tokens, lines, (const TOKEN_OPTIONS<T> *)NULL, strLength);
 }
+
+
+/**
+*   \brief                 Extracts a list of tokens from the specified string into a compact token_array.
+*   \param  str       [in] The string to tokenise.
+*   \param  tokens    [in] A reference to the list that will recieve the tokens.
+*   \param  options   [in] The various options to use when extracting the tokens.
+*   \param  strLength [in] The length in T's of the input string, not including the null terminator.
+*
+*   \remarks
+*       This is the same as the other version of extracttokens(), except that the kind of each
+*       token is stored as well. The lines are the same.
+*       \par
+*       If \c tokens is empty, room is reserved for token_array::estimate() tokens first. If it
+*       isn't, it must already refer to \c str, and the new tokens are added to the end.
+*/
+template <typename T>
+void extracttokens(T *str, token_array<T> &tokens, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    if (tokens.empty())
+    {
+        tokens.base = str;
+        tokens.reserve(token_array<T>::estimate((strLength == (size_t)-1) ? length(str) : strLength));
+    }
+
+    T *end = (strLength == (size_t)-1) ? NULL : str + strLength;
+
+    reference_string<T> cur_token;
+    size_t cur_line;
+    TOKEN_KIND cur_kind;
+    while (nexttoken(str, cur_token, &cur_line, options, (end == NULL) ? (size_t)-1 : ((str < end) ? (size_t)(end - str) : 0), &cur_kind))
+    {
+        tokens.push_back(cur_token, cur_kind, cur_line);
+    }
+}
+
+template <typename T>
+void extracttokens(T *str, token_array<T> &tokens, size_t strLength = -1)
+{
+    extracttokens(str, tokens, (const TOKEN_OPTIONS<T> *)NULL, strLength);
+}
 }
 
 #endif // DRSL_TOKENS_EXTRACTTOKENS
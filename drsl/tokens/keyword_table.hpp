@@ -0,0 +1,336 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TOKENS_KEYWORD_TABLE
+#define DRSL_TOKENS_KEYWORD_TABLE
+
+namespace drsl
+{
+
+/**
+*   \brief  Class for mapping words to keyword IDs with a single hash lookup.
+*
+*   The keywords are given as a space separated list, in the same format as the option lists in
+*   TOKEN_OPTIONS. The ID of a keyword is its position in the list, starting at 0, so the IDs can
+*   line up with an enum and be used in a switch.
+*
+*   When the table is built, a hash seed and table size are searched for so that every keyword
+*   lands in a slot of its own. Looking up a word then means hashing it and comparing it against
+*   at most one keyword. Words whose length or first code unit doesn't match any keyword are
+*   rejected without being hashed.
+*/
+template <typename T>
+class keyword_table
+{
+public:
+
+    /**
+    *   \brief  Default constructor. The table is empty until build() is called.
+    */
+    keyword_table()
+        : storage(), entries(), slots(), seed(0), mask(0), maxProbe(0), minLength(0), maxLength(0)
+    {
+        memset(this->firstUnits, 0, sizeof(this->firstUnits));
+    }
+
+    /**
+    *   \brief            Constructor.
+    *   \param  list [in] The space separated list of keywords. Can be NULL.
+    */
+    explicit keyword_table(const T *list)
+        : storage(), entries(), slots(), seed(0), mask(0), maxProbe(0), minLength(0), maxLength(0)
+    {
+        this->build(list);
+    }
+
+
+    /**
+    *   \brief            Builds the table from the specified list, replacing the existing one.
+    *   \param  list [in] The space separated list of keywords. Can be NULL.
+    *
+    *   \remarks
+    *       The list is copied, so it doesn't need to stay around after this returns.
+    *       \par
+    *       An empty entry (caused by two spaces in a row) still takes up an ID, but never matches
+    *       anything. If a keyword appears more than once, the first ID is the one that is found.
+    */
+    void build(const T *list)
+    {
+        this->clear();
+
+        if (list == NULL)
+        {
+            return;
+        }
+
+        _entry entry;
+        entry.offset = 0;
+        entry.length = 0;
+        for ( ; ; ++list)
+        {
+            if (*list == ' ' || *list == '\0')
+            {
+                this->entries.push_back(entry);
+
+                entry.offset = this->storage.size();
+                entry.length = 0;
+
+                if (*list == '\0')
+                {
+                    break;
+                }
+            }
+            else
+            {
+                this->storage.push_back(*list);
+                entry.length += 1;
+            }
+        }
+
+        this->_buildslots();
+    }
+
+    /**
+    *   \brief  Removes every keyword.
+    */
+    void clear()
+    {
+        this->storage.clear();
+        this->entries.clear();
+        this->slots.clear();
+        this->seed      = 0;
+        this->mask      = 0;
+        this->maxProbe  = 0;
+        this->minLength = 0;
+        this->maxLength = 0;
+        memset(this->firstUnits, 0, sizeof(this->firstUnits));
+    }
+
+
+    /**
+    *   \brief  Retrieves the number of IDs, which is the number of entries in the list.
+    */
+    size_t count() const
+    {
+        return this->entries.size();
+    }
+
+    /**
+    *   \brief  Determines whether or not there are any keywords to find.
+    */
+    bool empty() const
+    {
+        return this->slots.empty();
+    }
+
+    /**
+    *   \brief             Retrieves the ID of the keyword equal to the specified string.
+    *   \param  str   [in] The start of the string.
+    *   \param  end   [in] The end of the string.
+    *   \return            The ID of the keyword, or -1 if the string is not a keyword.
+    *
+    *   \remarks
+    *       The comparison is code unit by code unit, and is case sensitive.
+    */
+    int find(const T *str, const T *end) const
+    {
+        size_t str_length = (size_t)(end - str);
+        if (this->slots.empty() || str_length < this->minLength || str_length > this->maxLength)
+        {
+            return -1;
+        }
+
+        char32_t first = _codeunit(*str);
+        if (!this->firstUnits[(first < 128) ? first : 128])
+        {
+            return -1;
+        }
+
+        size_t slot = _slot(_hash(str, str_length, this->seed), this->mask);
+        for (size_t iProbe = 0; iProbe <= this->maxProbe; ++iProbe)
+        {
+            uint32_t index = this->slots[(slot + iProbe) & this->mask];
+            if (index == 0)
+            {
+                break;
+            }
+
+            const _entry &entry = this->entries[index - 1];
+            if (entry.length == str_length && _unitsequal(&this->storage[entry.offset], str, str_length))
+            {
+                return (int)(index - 1);
+            }
+        }
+
+        return -1;
+    }
+
+    int find(const reference_string<T> &str) const
+    {
+        return this->find(str.start, str.end);
+    }
+
+
+
+private:
+
+    /// A keyword, stored in 'storage'.
+    struct _entry
+    {
+        size_t offset;
+        size_t length;
+    };
+
+
+    // 32-bit FNV-1a over the code units, starting from the seed.
+    static uint32_t _hash(const T *str, size_t strLength, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (size_t i = 0; i < strLength; ++i)
+        {
+            hash ^= (uint32_t)_codeunit(str[i]);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    static size_t _slot(uint32_t hash, size_t mask)
+    {
+        return (size_t)(hash ^ (hash >> 15)) & mask;
+    }
+
+    static bool _unitsequal(const T *a, const T *b, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (a[i] != b[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Places each keyword in a slot. A seed that gives every keyword its own slot is tried for
+    // first, doubling the table size every so often. Should that never happen, the last attempt
+    // is kept with linear probing, which is still correct but not a single comparison.
+    void _buildslots()
+    {
+        std::vector<size_t> unique;
+        for (size_t i = 0; i < this->entries.size(); ++i)
+        {
+            const _entry &entry = this->entries[i];
+            if (entry.length == 0)
+            {
+                continue;
+            }
+
+            bool duplicate = false;
+            for (size_t j = 0; j < unique.size() && !duplicate; ++j)
+            {
+                const _entry &other = this->entries[unique[j]];
+                duplicate = other.length == entry.length && _unitsequal(&this->storage[other.offset], &this->storage[entry.offset], entry.length);
+            }
+
+            if (duplicate)
+            {
+                continue;
+            }
+
+            unique.push_back(i);
+
+            if (unique.size() == 1 || entry.length < this->minLength)
+            {
+                this->minLength = entry.length;
+            }
+            if (entry.length > this->maxLength)
+            {
+                this->maxLength = entry.length;
+            }
+
+            char32_t first = _codeunit(this->storage[entry.offset]);
+            this->firstUnits[(first < 128) ? first : 128] = true;
+        }
+
+        if (unique.empty())
+        {
+            return;
+        }
+
+        size_t size = 4;
+        while (size < unique.size() * 2)
+        {
+            size *= 2;
+        }
+
+        const uint32_t attempts_per_size = 32;
+        const size_t largest_size = size * 16;
+
+        for (uint32_t attempt = 0; ; ++attempt)
+        {
+            if (attempt > 0 && attempt % attempts_per_size == 0 && size < largest_size)
+            {
+                size *= 2;
+            }
+
+            this->seed     = attempt * 0x9E3779B9u;
+            this->mask     = size - 1;
+            this->maxProbe = 0;
+            this->slots.assign(size, 0);
+
+            for (size_t i = 0; i < unique.size(); ++i)
+            {
+                const _entry &entry = this->entries[unique[i]];
+
+                size_t slot = _slot(_hash(&this->storage[entry.offset], entry.length, this->seed), this->mask);
+                size_t probe = 0;
+                while (this->slots[(slot + probe) & this->mask] != 0)
+                {
+                    probe += 1;
+                }
+
+                this->slots[(slot + probe) & this->mask] = (uint32_t)(unique[i] + 1);
+                if (probe > this->maxProbe)
+                {
+                    this->maxProbe = probe;
+                }
+            }
+
+            if (this->maxProbe == 0 || (size >= largest_size && attempt % attempts_per_size == attempts_per_size - 1))
+            {
+                break;
+            }
+        }
+    }
+
+
+    /// The characters of every keyword.
+    std::vector<T> storage;
+
+    /// Every entry in the list, in list order. The index is the ID.
+    std::vector<_entry> entries;
+
+    /// The hash table. Each slot is an ID plus one, or 0 if it's empty.
+    std::vector<uint32_t> slots;
+
+    /// The seed for the hash function.
+    uint32_t seed;
+
+    /// The size of the hash table minus one. The size is a power of two.
+    size_t mask;
+
+    /// The number of slots past the first one that need checking. This is 0 for a perfect hash.
+    size_t maxProbe;
+
+    /// The lengths of the shortest and longest keywords.
+    size_t minLength;
+    size_t maxLength;
+
+    /// Whether or not a keyword starts with each ASCII code unit, plus one for anything else.
+    bool firstUnits[129];
+};
+
+}
+
+#endif // DRSL_TOKENS_KEYWORD_TABLE
@@ -15,7 +15,7 @@ struct TOKEN_OPTIONS
     *   \brief  Constructor.
     */
     TOKEN_OPTIONS()
-        : symbolGroups(NULL), quotes(NULL), escapeCharacter('\0'), ignoreBlockStart(NULL), ignoreBlockEnd(NULL)
+        : symbolGroups(NULL), quotes(NULL), escapeCharacter('\0'), ignoreBlockStart(NULL), ignoreBlockEnd(NULL), keywords(NULL)
     {
     }
 
@@ -62,57 +62,74 @@ struct TOKEN_OPTIONS
     *   \brief The list of ending ignore block strings.
     */
     T *ignoreBlockEnd;
+
+
+    /**
+    *   \brief The list of keywords.
+    *
+    *   This should be a null terminated string with each keyword seperated by a space. The ID
+    *   of a keyword is its position in the list, starting at 0. Word tokens that are equal to a
+    *   keyword are tagged with its ID by compiled_tokenizer (see keyword_table). This has no
+    *   effect on which tokens are found, and nexttoken() ignores it.
+    */
+    T *keywords;
 };
 
 
 /**
-*   \brief                      Retrieves the next token and moves the pointer to the end of that token.
-*   \param  str       [in, out] The string to retrieve the next token from.
-*   \param  token     [out]     The reference string that will recieve the next token.
-*   \param  line      [out]     The integer that will recieve the zero based line that the token is on.
-*   \param  options   [in]      The various options to use when retrieving the next token.
-*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
-*   \return                     True if a token is retrieved; false otherwise.
-*
-*   \remarks
-*       This function does not behave like strtok().
-*       \par
-*       The source string must be null terminated. When the null terminator is reached, the
-*       function will return false and the pointer will not be modified.
-*       \par
-*       When the token is retrieved, the input pointer is moved to the position just the
-*       end of the returned token and _not_ to the start of the next token. Therefore, when
-*       when the function returns, \c str == \c token.end.
-*       \par
-*       The line parameter is used to determine the line in the string that the token is
-*       found on. This is useful for things like source code parses so that they know the
-*       line that the token is on. This can then be used to output useful debug information
-*       or whatnot.
-*       \par
-*       A token is _always_ seperated by non-printable characters, spaces and tabs. If this
-*       is insufficient, use a different tokeniser. In addition, these non-printable
-*       characters, spaces and tabs will never be part of any tokens except those enclosed
-*       by quotes.
-*       \par
-*       Any non-letter and non-number is considered a symbol. Each symbol is it's own token.
-*       A group of symbols can be considered to be a single token by setting the \c symbolGroups
-*       string in the \c options structure.
-*       \par
-*       A quote is considered a single token. The quote symbols are included in the token.
-*       Quotes are useful for keeping the formatting of a particular part of the string. A quote
-*       character itself can be part of a quote, but must be preceeded by the escape character.
-*       The escape character is always included in the returned string.
-*       \par
-*       Sections of the string can be ignored by setting the \c ignoreBlockStart and
-*       \c ignoreBlockEnd strings in the \c options structure. If a starting ignore block string
-*       is found, but a matching ending ignore block string is not found before the null
-*       terminator, the section from the start of the ignore block to the end of the string is
-*       ignored.
-*       \par
-*       When the function returns false, the input string is not modified.
+*   \brief  The kinds of token returned by nexttoken().
 */
+enum TOKEN_KIND
+{
+    /// A run of letters, digits and underscores starting with a letter or underscore.
+    TOKEN_KIND_WORD,
+
+    /// A number, including a leading negative sign and a decimal point.
+    TOKEN_KIND_NUMBER,
+
+    /// A single symbol or a symbol group.
+    TOKEN_KIND_SYMBOL,
+
+    /// A quote, including the quote characters.
+    TOKEN_KIND_QUOTE
+};
+
+
+/**
+*   \brief  Structure describing a token returned by nexttoken(), so it doesn't need to be classified again.
+*/
+template <typename T>
+struct TOKEN_INFO
+{
+    /// The whole token.
+    reference_string<T> token;
+
+    /// The value of the token. For quotes this is what's between the quote characters, with any
+    /// escape characters left in. For everything else it's the same as \c token.
+    reference_string<T> value;
+
+    /// The kind of the token.
+    TOKEN_KIND kind;
+
+    /// For numbers, whether or not there's a decimal point. False for everything else.
+    bool decimal;
+
+    /// For quotes, the quote character. 0 for everything else.
+    char32_t quote;
+
+    /// For quotes, whether or not the closing quote character was found. A quote that runs to the
+    /// end of the string has no closing quote character. False for everything else.
+    bool closed;
+
+    /// The number of new lines between the start of the search and the end of the token, the same as the \c line output of nexttoken().
+    size_t line;
+};
+
+
+// The implementation of nexttoken(). 'type' receives the type of the token, as described below. The
+// other outputs are described where they're initialised.
 template <typename T>
-inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+inline bool _nexttoken(T *&str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options, size_t strLength, int &type, char32_t &starting_quote_ch, bool &found_decimal, bool &closed_quote)
 {
     assert(str != NULL);
 
@@ -129,29 +146,42 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
     //    - 3 means the token is a symbol.
     //    - 4 means the token is a quote.
     //    - 5 means the token is currently an ignore block.
-    int type = 0;
+    type = 0;
 
     // Stores the previous character that was just retrieved.
     char32_t prev_ch = '\0';
 
     // The character that has started a quote. If the token is not in a quote, this will
     // be equal to 0.
-    char32_t starting_quote_ch = '\0';
+    starting_quote_ch = '\0';
 
     // Determines if we've found a decimal point in a number. This is only used when type == 2.
-    bool found_decimal = false;
+    found_decimal = false;
+
+    // Whether or not a quote was ended by its closing quote character. This is only used when type == 4.
+    closed_quote = false;
 
     // Our string containing the start of our ignore block. This is only applicable when type == 5.
     reference_string<T> ignore_block_start;
     ignore_block_start.start = NULL;
     ignore_block_start.end = NULL;
 
+    // The end of the string, or NULL if it's null terminated. This is only used for skipping runs.
+    const T *end = (strLength == (size_t)-1) ? NULL : str + strLength;
+
     // To extract the next token, we need to start looking at each character. We will
     // loop until we reach the end of the string or we break out of the loop.
     T *temp = str;
     char32_t ch;
     while (strLength > 0 && (ch = nextchar(temp)) != '\0')
     {
+        // Set when the character starts a run of characters which all do the same thing as it. The
+        // rest of the run is skipped in one go at the bottom of the loop. The value is as follows:
+        //    - 0 means there is nothing to skip.
+        //    - 1 means a run of blanks (white space other than new lines).
+        //    - 2 means a run of letters and digits.
+        int run = 0;
+
         // We need to check which character we've got. If it's a non-printable character,
         // we want to ignore it and continue to the next character.
         if (ch > 0 && ch <= ' ')
@@ -184,6 +214,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
             }
 
             str = temp;
+            run = 1;
         }
         else
         {
@@ -199,6 +230,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                 }
 
                 str = temp;
+                run = 2;
             }
             else if (ch >= '0' && ch <= '9')
             {
@@ -210,6 +242,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                 }
 
                 str = temp;
+                run = 2;
             }
             else
             {
@@ -249,6 +282,8 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                                 temp = temp2;
                                 str = temp;
 
+                                type = 3;
+
                                 token.end = str;
                                 return true;
                             }
@@ -307,6 +342,9 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                         char32_t next_ch = nextchar(temp);
                         if (!(next_ch >= '0' && next_ch <= '9'))
                         {
+                            // The decimal point isn't part of the token after all.
+                            found_decimal = false;
+
                             token.end = str;
                             return true;
                         }
@@ -326,6 +364,8 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                     // values and then return true.
                     if (ch == starting_quote_ch && options != NULL && prev_ch != options->escapeCharacter)
                     {
+                        closed_quote = true;
+
                         str = temp;
                         token.end = str;
                         return true;
@@ -353,6 +393,31 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
 
         prev_ch = ch;
         strLength -= charwidth<T>(ch);
+
+        // Blanks and the letters and digits of words and numbers never change the state, so there's
+        // no need to decode them one at a time. They're all ASCII, so units and characters are the same.
+        //
+        // The run must stop where the character by character loop would have. That's strLength
+        // characters from here, which can be past the real end of the string because some of the
+        // characters above aren't counted - in that case the rest is left to the loop.
+        if (run != 0 && (end == NULL || temp < end))
+        {
+            const T *run_limit = end;
+            if (end != NULL && strLength < (size_t)(end - temp))
+            {
+                run_limit = temp + strLength;
+            }
+
+            const T *run_end = (run == 1) ? _skipblanks((const T *)temp, run_limit) : _skipidentifier((const T *)temp, run_limit);
+            if (run_end != temp)
+            {
+                prev_ch = _codeunit(run_end[-1]);
+                strLength -= run_end - temp;
+
+                temp += run_end - temp;
+                str = temp;
+            }
+        }
     }
 
     // We now need to ensure that if we have a token, we return true.
@@ -365,6 +430,123 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
     return false;
 }
 
+
+/**
+*   \brief                      Retrieves the next token and moves the pointer to the end of that token.
+*   \param  str       [in, out] The string to retrieve the next token from.
+*   \param  token     [out]     The reference string that will recieve the next token.
+*   \param  line      [out]     The integer that will recieve the zero based line that the token is on.
+*   \param  options   [in]      The various options to use when retrieving the next token.
+*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+*   \param  kind      [out]     Receives the kind of the token. Can be NULL.
+*   \return                     True if a token is retrieved; false otherwise.
+*
+*   \remarks
+*       This function does not behave like strtok().
+*       \par
+*       The source string must be null terminated. When the null terminator is reached, the
+*       function will return false and the pointer will not be modified.
+*       \par
+*       When the token is retrieved, the input pointer is moved to the position just the
+*       end of the returned token and _not_ to the start of the next token. Therefore, when
+*       when the function returns, \c str == \c token.end.
+*       \par
+*       The line parameter is used to determine the line in the string that the token is
+*       found on. This is useful for things like source code parses so that they know the
+*       line that the token is on. This can then be used to output useful debug information
+*       or whatnot.
+*       \par
+*       A token is _always_ seperated by non-printable characters, spaces and tabs. If this
+*       is insufficient, use a different tokeniser. In addition, these non-printable
+*       characters, spaces and tabs will never be part of any tokens except those enclosed
+*       by quotes.
+*       \par
+*       Any non-letter and non-number is considered a symbol. Each symbol is it's own token.
+*       A group of symbols can be considered to be a single token by setting the \c symbolGroups
+*       string in the \c options structure.
+*       \par
+*       A quote is considered a single token. The quote symbols are included in the token.
+*       Quotes are useful for keeping the formatting of a particular part of the string. A quote
+*       character itself can be part of a quote, but must be preceeded by the escape character.
+*       The escape character is always included in the returned string.
+*       \par
+*       Sections of the string can be ignored by setting the \c ignoreBlockStart and
+*       \c ignoreBlockEnd strings in the \c options structure. If a starting ignore block string
+*       is found, but a matching ending ignore block string is not found before the null
+*       terminator, the section from the start of the ignore block to the end of the string is
+*       ignored.
+*       \par
+*       When the function returns false, the input string is not modified.
+*/
+template <typename T>
+inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options, size_t strLength = -1, TOKEN_KIND *kind = NULL)
+{
+    int type;
+    char32_t quote;
+    bool decimal;
+    bool closed;
+    if (!_nexttoken(str, token, line, options, strLength, type, quote, decimal, closed))
+    {
+        return false;
+    }
+
+    if (kind != NULL)
+    {
+        *kind = (TOKEN_KIND)(type - 1);
+    }
+
+    return true;
+}
+
+/**
+*   \brief                      Retrieves the next token and a description of it, and moves the pointer to the end of that token.
+*   \param  str       [in, out] The string to retrieve the next token from.
+*   \param  info      [out]     The structure that will recieve the token and its description.
+*   \param  options   [in]      The various options to use when retrieving the next token.
+*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+*   \return                     True if a token is retrieved; false otherwise.
+*
+*   \remarks
+*       This is the same as the other versions of nexttoken(), but passes on what it learnt about
+*       the token while finding it. In particular \c info.value is a view of the inside of a
+*       quote, which can often be used instead of making a copy with removequotes().
+*/
+template <typename T>
+inline bool nexttoken(T *&str, TOKEN_INFO<T> &info, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+{
+    int type;
+    if (!_nexttoken(str, info.token, &info.line, options, strLength, type, info.quote, info.decimal, info.closed))
+    {
+        return false;
+    }
+
+    info.kind  = (TOKEN_KIND)(type - 1);
+    info.value = info.token;
+
+    if (type == 4)
+    {
+        size_t quote_width = charwidth<T>(info.quote);
+
+        info.value.start += quote_width;
+        if (info.closed)
+        {
+            info.value.end -= quote_width;
+        }
+    }
+    else
+    {
+        info.quote  = '\0';
+        info.closed = false;
+    }
+
+    if (type != 2)
+    {
+        info.decimal = false;
+    }
+
+    return true;
+}
+
 template <typename T>
 inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, size_t strLength = -1)
 {
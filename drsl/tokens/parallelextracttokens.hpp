@@ -0,0 +1,266 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TOKENS_PARALLELEXTRACTTOKENS
+#define DRSL_TOKENS_PARALLELEXTRACTTOKENS
+
+namespace drsl
+{
+
+/**
+*   \brief  The tokens found by one thread of parallelextracttokens(), starting from a guessed split point.
+*/
+template <typename T>
+struct _token_run
+{
+    /// Where the run started.
+    T *start;
+
+    /// The run stops after the first token that ends at or past this point. NULL for the last run.
+    T *stop;
+
+    /// Whether or not the run carried on to the end of the string.
+    bool reachedEnd;
+
+    std::vector<reference_string<T> > tokens;
+    std::vector<size_t> lines;
+};
+
+// Retrieves the length to pass to nexttoken() for the rest of the string, the same way extracttokens() does.
+template <typename T>
+inline size_t _remaininglength(const T *str, const T *end)
+{
+    if (end == NULL)
+    {
+        return (size_t)-1;
+    }
+
+    return (str < end) ? (size_t)(end - str) : 0;
+}
+
+template <typename T>
+inline void _tokenizerun(_token_run<T> *run, T *end, const TOKEN_OPTIONS<T> *options)
+{
+    T *str = run->start;
+    run->reachedEnd = true;
+
+    reference_string<T> token;
+    size_t line;
+    while (nexttoken(str, token, &line, options, _remaininglength(str, end)))
+    {
+        run->tokens.push_back(token);
+        run->lines.push_back(line);
+
+        if (run->stop != NULL && token.end >= run->stop)
+        {
+            run->reachedEnd = false;
+            break;
+        }
+    }
+}
+
+// Determines whether or not nexttoken() was called at 'position' during a run, which is true for the
+// start of the run and the end of each of its tokens. If so, 'index' receives the index of the
+// first token returned from that position.
+template <typename T>
+inline bool _findrunboundary(const _token_run<T> &run, const T *position, size_t &index)
+{
+    if (position == run.start)
+    {
+        index = 0;
+        return true;
+    }
+
+    size_t low  = 0;
+    size_t high = run.tokens.size();
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (run.tokens[middle].end < position)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low < run.tokens.size() && run.tokens[low].end == position)
+    {
+        index = low + 1;
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+*   \brief                   Extracts a list of tokens from the specified string using multiple threads.
+*   \param  str         [in] The string to tokenise.
+*   \param  tokens      [in] A reference to the list that will recieve the tokens.
+*   \param  lines       [in] A reference to the list that will recieve the lines of each token. Can be NULL.
+*   \param  options     [in] The various options to use when extracting the tokens.
+*   \param  strLength   [in] The length in T's of the input string, not including the null terminator.
+*   \param  threadCount [in] The number of threads to use, including the calling thread. 0 means one per hardware thread.
+*
+*   \remarks
+*       The output is exactly the same as extracttokens() with the same arguments.
+*       \par
+*       The string is split into one part per thread, with each split just after a new line.
+*       Each thread tokenises its part as if a call to nexttoken() started at the split. The
+*       guess is wrong if the split is inside a quote or an ignore block, and the first token
+*       after a split can have a different line count. The results are then stitched together
+*       in order. The tokens of the previous part are followed from the split until one of them
+*       ends where one of the next part's tokens ends. Both sequences of calls to nexttoken() are
+*       the same after that point. If they never meet, the calls are made again on this thread
+*       until they do.
+*       \par
+*       Strings under a megabyte are handled by extracttokens() directly.
+*/
+template <typename T>
+void parallelextracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines, const TOKEN_OPTIONS<T> *options, size_t strLength = -1, unsigned int threadCount = 0)
+{
+    assert(str != NULL);
+
+    T *end = (strLength == (size_t)-1) ? NULL : str + strLength;
+    size_t total_length = (end == NULL) ? length(str) : strLength;
+
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    if (threadCount > total_length / (512 * 1024))
+    {
+        threadCount = (unsigned int)(total_length / (512 * 1024));
+    }
+
+    if (threadCount <= 1)
+    {
+        extracttokens(str, tokens, lines, options, strLength);
+        return;
+    }
+
+
+    // Split just after a new line near each multiple of the part size. Parts with no new line in
+    // them are merged into the previous one.
+    std::vector<_token_run<T> > runs(1);
+    runs[0].start = str;
+
+    const T *str_end = str + total_length;
+    for (unsigned int iPart = 1; iPart < threadCount; ++iPart)
+    {
+        const T *guess = str + (total_length / threadCount) * iPart;
+        if (guess <= runs.back().start)
+        {
+            continue;
+        }
+
+        const T *new_line = _findeither(guess, str_end, (T)'\n', (T)'\n');
+        if (new_line + 1 >= str_end)
+        {
+            break;
+        }
+
+        runs.push_back(_token_run<T>());
+        runs.back().start = str + (new_line + 1 - str);
+    }
+
+    for (size_t iRun = 0; iRun < runs.size(); ++iRun)
+    {
+        runs[iRun].stop = (iRun + 1 < runs.size()) ? runs[iRun + 1].start : NULL;
+    }
+
+
+    std::vector<std::thread> threads;
+    for (size_t iRun = 1; iRun < runs.size(); ++iRun)
+    {
+        threads.push_back(std::thread(_tokenizerun<T>, &runs[iRun], end, options));
+    }
+
+    _tokenizerun(&runs[0], end, options);
+
+    for (size_t iThread = 0; iThread < threads.size(); ++iThread)
+    {
+        threads[iThread].join();
+    }
+
+
+    // The first run started at the start of the string, so it's correct.
+    tokens.insert(tokens.end(), runs[0].tokens.begin(), runs[0].tokens.end());
+    if (lines != NULL)
+    {
+        lines->insert(lines->end(), runs[0].lines.begin(), runs[0].lines.end());
+    }
+
+    bool finished = runs[0].reachedEnd;
+    T *position = runs[0].tokens.empty() ? str : runs[0].tokens.back().end;
+
+    reference_string<T> token;
+    size_t line;
+    for (size_t iRun = 1; iRun < runs.size() && !finished; ++iRun)
+    {
+        const _token_run<T> &run = runs[iRun];
+        const T *run_last = run.tokens.empty() ? run.start : run.tokens.back().end;
+
+        for (;;)
+        {
+            size_t index;
+            if (_findrunboundary(run, position, index))
+            {
+                tokens.insert(tokens.end(), run.tokens.begin() + index, run.tokens.end());
+                if (lines != NULL)
+                {
+                    lines->insert(lines->end(), run.lines.begin() + index, run.lines.end());
+                }
+
+                if (index < run.tokens.size())
+                {
+                    position = run.tokens.back().end;
+                }
+
+                finished = run.reachedEnd;
+                break;
+            }
+
+            // Once we've gone past the end of this run it's of no use.
+            if (position > run_last)
+            {
+                break;
+            }
+
+            if (!nexttoken(position, token, &line, options, _remaininglength(position, end)))
+            {
+                finished = true;
+                break;
+            }
+
+            tokens.push_back(token);
+            if (lines != NULL)
+            {
+                lines->push_back(line);
+            }
+        }
+    }
+
+    // Only needed if the last run couldn't be joined up.
+    while (!finished && nexttoken(position, token, &line, options, _remaininglength(position, end)))
+    {
+        tokens.push_back(token);
+        if (lines != NULL)
+        {
+            lines->push_back(line);
+        }
+    }
+}
+
+template <typename T>
+void parallelextracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines, size_t strLength = -1, unsigned int threadCount = 0)
+{
+    parallelextracttokens(str, tokens, lines, (const TOKEN_OPTIONS<T> *)NULL, strLength, threadCount);
+}
+
+}
+
+#endif // DRSL_TOKENS_PARALLELEXTRACTTOKENS
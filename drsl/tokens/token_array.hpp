@@ -0,0 +1,156 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TOKENS_TOKEN_ARRAY
+#define DRSL_TOKENS_TOKEN_ARRAY
+
+namespace drsl
+{
+
+/**
+*   \brief  A compact list of tokens, stored as a structure of arrays.
+*
+*   Each token is a 32-bit offset from the start of the tokenised string and a 32-bit length,
+*   rather than two pointers. The kind and line of each token are kept in their own arrays.
+*   A token costs 13 bytes in total, compared to 24 bytes for a reference_string and a size_t
+*   line on a 64-bit build. A loop that only looks at one of the arrays touches even less memory.
+*
+*   The string must be less than 4GB in T's.
+*/
+template <typename T>
+class token_array
+{
+public:
+
+    /**
+    *   \brief  Default constructor.
+    */
+    token_array()
+        : base(NULL), offsets(), lengths(), kinds(), lines()
+    {
+    }
+
+
+    /**
+    *   \brief  Retrieves the number of tokens.
+    */
+    size_t size() const
+    {
+        return this->offsets.size();
+    }
+
+    /**
+    *   \brief  Determines whether or not the list is empty.
+    */
+    bool empty() const
+    {
+        return this->offsets.empty();
+    }
+
+    /**
+    *   \brief  Retrieves the token at the specified index as a reference string.
+    */
+    reference_string<T> operator[](size_t index) const
+    {
+        assert(index < this->size());
+
+        reference_string<T> token;
+        token.start = this->base + this->offsets[index];
+        token.end   = token.start + this->lengths[index];
+
+        return token;
+    }
+
+    /**
+    *   \brief  Retrieves the kind of the token at the specified index.
+    */
+    TOKEN_KIND kind(size_t index) const
+    {
+        assert(index < this->size());
+        return (TOKEN_KIND)this->kinds[index];
+    }
+
+    /**
+    *   \brief  Retrieves the line of the token at the specified index. See extracttokens() for what the line means.
+    */
+    size_t line(size_t index) const
+    {
+        assert(index < this->size());
+        return this->lines[index];
+    }
+
+
+    /**
+    *   \brief              Adds a token to the end of the list.
+    *   \param  token [in] The token. This must be inside the string that \c base points to.
+    *   \param  kind  [in] The kind of the token.
+    *   \param  line  [in] The line of the token.
+    */
+    void push_back(const reference_string<T> &token, TOKEN_KIND kind, size_t line)
+    {
+        assert(this->base != NULL && token.start >= this->base);
+        assert((size_t)(token.end - this->base) <= 0xFFFFFFFF);
+        assert(line <= 0xFFFFFFFF);
+
+        this->offsets.push_back((uint32_t)(token.start - this->base));
+        this->lengths.push_back((uint32_t)(token.end - token.start));
+        this->kinds.push_back((unsigned char)kind);
+        this->lines.push_back((uint32_t)line);
+    }
+
+    /**
+    *   \brief  Removes every token. The string the tokens point into is forgotten as well.
+    */
+    void clear()
+    {
+        this->base = NULL;
+        this->offsets.clear();
+        this->lengths.clear();
+        this->kinds.clear();
+        this->lines.clear();
+    }
+
+    /**
+    *   \brief  Makes room for the specified number of tokens.
+    */
+    void reserve(size_t count)
+    {
+        this->offsets.reserve(count);
+        this->lengths.reserve(count);
+        this->kinds.reserve(count);
+        this->lines.reserve(count);
+    }
+
+    /**
+    *   \brief                  Estimates the number of tokens in a string of the specified length.
+    *   \param  strLength [in]  The length in T's of the string.
+    *
+    *   \remarks
+    *       This is based on source code, which averages five to ten T's per token once white
+    *       space and comments are taken into account. It errs on the side of too many, so that
+    *       reserving this many tokens up front usually avoids reallocating.
+    */
+    static size_t estimate(size_t strLength)
+    {
+        return strLength / 5 + 16;
+    }
+
+
+    /// The start of the string the tokens are in. The offsets are relative to this.
+    T *base;
+
+    /// The offset in T's of the start of each token.
+    std::vector<uint32_t> offsets;
+
+    /// The length in T's of each token.
+    std::vector<uint32_t> lengths;
+
+    /// The TOKEN_KIND of each token.
+    std::vector<unsigned char> kinds;
+
+    /// The line of each token.
+    std::vector<uint32_t> lines;
+};
+
+}
+
+#endif // DRSL_TOKENS_TOKEN_ARRAY
@@ -0,0 +1,179 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TOKENS_TOKEN_CURSOR
+#define DRSL_TOKENS_TOKEN_CURSOR
+
+namespace drsl
+{
+
+/**
+*   \brief  Class for walking through the tokens of a string while keeping track of where each one is.
+*
+*   nexttoken() only reports the number of new lines it passed over during the call, so getting
+*   the absolute line of a token means adding those up, and getting the column means scanning
+*   back. The cursor does this incrementally as it goes, looking at each part of the string once.
+*
+*   The tokens are the same as those returned by nexttoken(), or by a compiled_tokenizer if one is
+*   given.
+*/
+template <typename T>
+class token_cursor
+{
+public:
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to tokenise.
+    *   \param  options   [in] The options to pass to nexttoken(). Can be NULL.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    */
+    explicit token_cursor(T *str, const TOKEN_OPTIONS<T> *options = NULL, size_t strLength = -1)
+        : str(str), end(NULL), current(str), options(options), tokenizer(NULL), tracked(str), trackedPosition(), tokenPosition()
+    {
+        this->_init(strLength);
+    }
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to tokenise.
+    *   \param  tokenizer [in] The compiled tokenizer to use. This must stay around for as long as the cursor is used.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    */
+    token_cursor(T *str, const compiled_tokenizer<T> *tokenizer, size_t strLength = -1)
+        : str(str), end(NULL), current(str), options(NULL), tokenizer(tokenizer), tracked(str), trackedPosition(), tokenPosition()
+    {
+        assert(tokenizer != NULL);
+        this->_init(strLength);
+    }
+
+
+    /**
+    *   \brief                 Retrieves the next token.
+    *   \param  token    [out] The reference string that will recieve the next token.
+    *   \param  position [out] Receives the position of the start of the token. Can be NULL.
+    *   \return                True if a token is retrieved; false otherwise.
+    *
+    *   \remarks
+    *       The position of the token is also available from position() until the next call.
+    */
+    bool next(reference_string<T> &token, TEXT_POSITION *position = NULL)
+    {
+        size_t remaining = (size_t)-1;
+        if (this->end != NULL)
+        {
+            remaining = (this->current < this->end) ? (size_t)(this->end - this->current) : 0;
+        }
+
+        bool found;
+        if (this->tokenizer != NULL)
+        {
+            found = this->tokenizer->nexttoken(this->current, token, NULL, remaining);
+        }
+        else
+        {
+            found = nexttoken(this->current, token, NULL, this->options, remaining);
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+
+        this->_advanceto(token.start);
+        this->tokenPosition = this->trackedPosition;
+
+        if (position != NULL)
+        {
+            *position = this->tokenPosition;
+        }
+
+        return true;
+    }
+
+
+    /**
+    *   \brief  Retrieves the position of the start of the token returned by the last successful call to next().
+    */
+    const TEXT_POSITION & position() const
+    {
+        return this->tokenPosition;
+    }
+
+    /**
+    *   \brief  Retrieves the position in the string where the search for the next token will start.
+    */
+    T * pointer() const
+    {
+        return this->current;
+    }
+
+
+
+private:
+
+    void _init(size_t strLength)
+    {
+        assert(this->str != NULL);
+
+        if (strLength != (size_t)-1)
+        {
+            this->end = this->str + strLength;
+        }
+
+        this->trackedPosition.offset      = 0;
+        this->trackedPosition.line        = 0;
+        this->trackedPosition.column      = 0;
+        this->trackedPosition.columnUnits = 0;
+        this->tokenPosition = this->trackedPosition;
+    }
+
+    // Moves the tracked position forward to 'target', counting the new lines and characters in between.
+    void _advanceto(const T *target)
+    {
+        assert(target >= this->tracked);
+
+        const T *temp = this->tracked;
+        const T *new_line;
+        while ((new_line = _findeither(temp, target, (T)'\n', (T)'\n')) != target)
+        {
+            this->trackedPosition.line       += 1;
+            this->trackedPosition.column      = 0;
+            this->trackedPosition.columnUnits = 0;
+
+            temp = new_line + 1;
+        }
+
+        this->trackedPosition.offset      += (size_t)(target - this->tracked);
+        this->trackedPosition.column      += _countchars(temp, target);
+        this->trackedPosition.columnUnits += (size_t)(target - temp);
+
+        this->tracked = target;
+    }
+
+
+    /// The string being tokenised.
+    T *str;
+
+    /// The end of the string, or NULL if it's null terminated.
+    T *end;
+
+    /// Where the search for the next token starts.
+    T *current;
+
+    /// The options to pass to nexttoken(). Not used when 'tokenizer' is set.
+    const TOKEN_OPTIONS<T> *options;
+
+    /// The compiled tokenizer, or NULL if nexttoken() is used.
+    const compiled_tokenizer<T> *tokenizer;
+
+    /// The point in the string that 'trackedPosition' describes. This only ever moves forward.
+    const T *tracked;
+    TEXT_POSITION trackedPosition;
+
+    /// The position of the start of the last token.
+    TEXT_POSITION tokenPosition;
+};
+
+}
+
+#endif // DRSL_TOKENS_TOKEN_CURSOR
@@ -0,0 +1,235 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TOKENS_TOKEN_RANGE
+#define DRSL_TOKENS_TOKEN_RANGE
+
+namespace drsl
+{
+
+/**
+*   \brief  A range over the tokens of a string, as returned by tokens().
+*
+*   Nothing is tokenised until the range is iterated, and then only one token at a time. Each
+*   step is a call to nexttoken(), so breaking out of a loop early leaves the rest of the string
+*   untouched, and no list of tokens is built up.
+*
+*   The string is referenced, not copied, so it must stay around for as long as the range and
+*   its iterators are used. The same goes for the options.
+*/
+template <typename T>
+class token_range
+{
+public:
+
+    /**
+    *   \brief  Iterator over the tokens of a token_range. Each step moves to the next token.
+    */
+    class iterator
+    {
+    public:
+
+        typedef std::input_iterator_tag iterator_category;
+        typedef reference_string<T>      value_type;
+        typedef ptrdiff_t                difference_type;
+        typedef const reference_string<T> * pointer;
+        typedef const reference_string<T> & reference;
+
+
+        /**
+        *   \brief  Default constructor. This is the end iterator.
+        */
+        iterator()
+            : str(NULL), end(NULL), options(NULL), token(), tokenLine(0), tokenKind(TOKEN_KIND_WORD)
+        {
+        }
+
+        /**
+        *   \brief  Constructor. Moves to the first token straight away.
+        */
+        iterator(T *str, T *end, const TOKEN_OPTIONS<T> *options)
+            : str(str), end(end), options(options), token(), tokenLine(0), tokenKind(TOKEN_KIND_WORD)
+        {
+            this->_next();
+        }
+
+
+        reference operator*() const
+        {
+            assert(this->str != NULL);
+            return this->token;
+        }
+
+        pointer operator->() const
+        {
+            assert(this->str != NULL);
+            return &this->token;
+        }
+
+        iterator & operator++()
+        {
+            assert(this->str != NULL);
+            this->_next();
+
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++(*this);
+
+            return temp;
+        }
+
+
+        /**
+        *   \brief  Retrieves the number of new lines between the end of the previous token and the end of the current one. See nexttoken().
+        */
+        size_t line() const
+        {
+            return this->tokenLine;
+        }
+
+        /**
+        *   \brief  Retrieves the kind of the current token.
+        */
+        TOKEN_KIND kind() const
+        {
+            return this->tokenKind;
+        }
+
+        /**
+        *   \brief  Retrieves the position in the string where the search for the next token will start.
+        */
+        T * position() const
+        {
+            return this->str;
+        }
+
+
+        // Iterators are only compared against the end iterator in practice. Two iterators are
+        // equal if they're both at the end, or both on the same token.
+        bool operator==(const iterator &other) const
+        {
+            return this->str == other.str && this->token.start == other.token.start;
+        }
+
+        bool operator!=(const iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+
+    private:
+
+        void _next()
+        {
+            size_t remaining = (size_t)-1;
+            if (this->end != NULL)
+            {
+                remaining = (this->str < this->end) ? (size_t)(this->end - this->str) : 0;
+            }
+
+            if (!nexttoken(this->str, this->token, &this->tokenLine, this->options, remaining, &this->tokenKind))
+            {
+                // Become the end iterator.
+                *this = iterator();
+            }
+        }
+
+
+        /// Where the search for the next token starts. NULL once there are no more tokens.
+        T *str;
+
+        /// The end of the string, or NULL if it's null terminated.
+        T *end;
+
+        /// The options to pass to nexttoken().
+        const TOKEN_OPTIONS<T> *options;
+
+        /// The current token, and what nexttoken() said about it.
+        reference_string<T> token;
+        size_t tokenLine;
+        TOKEN_KIND tokenKind;
+    };
+
+    typedef iterator const_iterator;
+
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to tokenise.
+    *   \param  options   [in] The options to pass to nexttoken(). Can be NULL.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    */
+    token_range(T *str, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+        : str(str), strEnd(NULL), options(options)
+    {
+        assert(str != NULL);
+
+        if (strLength != (size_t)-1)
+        {
+            this->strEnd = str + strLength;
+        }
+    }
+
+
+    /**
+    *   \brief  Retrieves an iterator to the first token. This is where the first call to nexttoken() is made.
+    */
+    iterator begin() const
+    {
+        return iterator(this->str, this->strEnd, this->options);
+    }
+
+    /**
+    *   \brief  Retrieves the end iterator.
+    */
+    iterator end() const
+    {
+        return iterator();
+    }
+
+
+private:
+
+    /// The string to tokenise.
+    T *str;
+
+    /// The end of the string, or NULL if it's null terminated.
+    T *strEnd;
+
+    /// The options to pass to nexttoken().
+    const TOKEN_OPTIONS<T> *options;
+};
+
+
+/**
+*   \brief                 Retrieves a range over the tokens of a string, for use in range-based for loops.
+*   \param  str       [in] The string to tokenise.
+*   \param  options   [in] The various options to use when extracting the tokens.
+*   \param  strLength [in] The length in T's of the input string, not including the null terminator.
+*
+*   \remarks
+*       This produces the same tokens as extracttokens(), but one at a time as the loop asks for
+*       them rather than all at once. A loop that only needs the first few tokens can stop early
+*       without the rest of the string being looked at.
+*       \par
+*       Each token is a reference_string into the input. Use the iterator directly to get the line
+*       and kind of each token as well.
+*/
+template <typename T>
+inline token_range<T> tokens(T *str, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+{
+    return token_range<T>(str, options, strLength);
+}
+
+template <typename T>
+inline token_range<T> tokens(T *str, size_t strLength = -1)
+{
+    return token_range<T>(str, (const TOKEN_OPTIONS<T> *)NULL, strLength);
+}
+
+}
+
+#endif // DRSL_TOKENS_TOKEN_RANGE
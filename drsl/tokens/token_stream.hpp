@@ -0,0 +1,338 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TOKENS_TOKEN_STREAM
+#define DRSL_TOKENS_TOKEN_STREAM
+
+namespace drsl
+{
+
+/**
+*   \brief  Class for tokenising input that arrives in chunks, without joining the chunks together first.
+*
+*   Each chunk is tokenised where it is. Near the end of a chunk, more of the input could change
+*   how the string is tokenised, so the scan stops compiled_tokenizer::lookahead() T's short of
+*   the end and remembers where it was: between tokens, inside an ignore block, or part way
+*   through a word, number or quote. The next chunk carries on from there, so nothing is scanned
+*   twice.
+*
+*   The last few T's of the chunk are kept in a spill buffer, along with the start of a token that
+*   isn't finished yet. Only as much of the next chunk as it takes to get past them, or to finish
+*   the token, is appended to the spill buffer. An ignore block that spans several chunks keeps
+*   nothing but where it's up to.
+*
+*   The tokens and line counts are the same as those from compiled_tokenizer::extracttokens()
+*   on all of the chunks joined together. Each line count is the number of new lines since the
+*   end of the previous token, even if that token was in an earlier chunk.
+*
+*   A token returned by feed() or finish() points either into the chunk it was found in, or
+*   into the spill buffer. Tokens in the spill buffer stay valid until the next call to feed(),
+*   finish() or reset(). Tokens in a chunk stay valid for as long as the chunk's memory does.
+*/
+template <typename T>
+class token_stream
+{
+public:
+
+    /**
+    *   \brief               Constructor.
+    *   \param  options [in] The tokenising options. Can be NULL. These are compiled, so they don't need to stay around.
+    */
+    explicit token_stream(const TOKEN_OPTIONS<T> *options = NULL)
+        : tokenizer(options), lookaheadLength(0), scan(), carried(), carriedToken(0), carriedPosition(0), spill(), stopped(false)
+    {
+        this->lookaheadLength = this->tokenizer.lookahead();
+        this->scan = compiled_tokenizer<T>::_newscan();
+    }
+
+
+    /**
+    *   \brief                   Tokenises the next chunk of input.
+    *   \param  chunk       [in] The next chunk of input. It does not need to be null terminated, and must not contain a null character.
+    *   \param  chunkLength [in] The length in T's of the chunk.
+    *   \param  tokens      [in] A reference to the list that will recieve the tokens that were completed by this chunk.
+    *   \param  lines       [in] A reference to the list that will recieve the lines of each token. Can be NULL.
+    *
+    *   \remarks
+    *       The tokens at the end of the chunk are held back until the next call to feed() or
+    *       finish(), since the next chunk could continue them.
+    *       \par
+    *       A token that spans several chunks is built up in the spill buffer, but is still only
+    *       scanned once. Ignore blocks and white space that span several chunks are not kept.
+    */
+    void feed(T *chunk, size_t chunkLength, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines)
+    {
+        assert(chunk != NULL || chunkLength == 0);
+
+        if (chunkLength == 0 || this->stopped)
+        {
+            return;
+        }
+
+        // The tokens from the last call aren't needed any more, so the buffer they were in can
+        // now receive what's carried over from this chunk.
+        std::swap(this->carried, this->spill);
+        this->carried.clear();
+
+        size_t chunk_position = 0;
+        if (!this->spill.empty())
+        {
+            if (!this->_feedspill(chunk, chunkLength, chunk_position, tokens, lines))
+            {
+                return;
+            }
+        }
+
+        const T *str  = chunk + chunk_position;
+        const T *end  = chunk + chunkLength;
+        const T *stop = (chunkLength > this->lookaheadLength) ? end - this->lookaheadLength : chunk;
+        const T *token_start = str;
+        const T *token_end;
+        for (;;)
+        {
+            int result = this->tokenizer._scan(str, end, stop, token_start, token_end, this->scan);
+            if (result != 1)
+            {
+                if (result == -1)
+                {
+                    this->_carry(token_start, str, end);
+                }
+                else
+                {
+                    this->stopped = true;
+                }
+
+                return;
+            }
+
+            this->_addtoken(chunk, token_start, token_end, tokens, lines);
+        }
+    }
+
+    /**
+    *   \brief               Tokenises whatever has been carried over from the last chunk, treating it as the end of the input.
+    *   \param  tokens [in] A reference to the list that will recieve the tokens.
+    *   \param  lines  [in] A reference to the list that will recieve the lines of each token. Can be NULL.
+    *
+    *   \remarks
+    *       The stream can be used again for new input afterwards.
+    */
+    void finish(std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines)
+    {
+        std::swap(this->carried, this->spill);
+        this->carried.clear();
+
+        if (!this->spill.empty() && !this->stopped)
+        {
+            T *spill_str = &this->spill[0];
+            const T *str = spill_str + this->carriedPosition;
+            const T *end = spill_str + this->spill.size();
+            const T *token_start = spill_str + this->carriedToken;
+            const T *token_end;
+            while (this->tokenizer._scan(str, end, end, token_start, token_end, this->scan) == 1)
+            {
+                this->_addtoken(spill_str, token_start, token_end, tokens, lines);
+            }
+        }
+
+        this->scan            = compiled_tokenizer<T>::_newscan();
+        this->carriedToken    = 0;
+        this->carriedPosition = 0;
+        this->stopped         = false;
+    }
+
+    /**
+    *   \brief  Throws away anything that has been carried over, ready for new input.
+    */
+    void reset()
+    {
+        this->scan = compiled_tokenizer<T>::_newscan();
+        this->carried.clear();
+        this->carriedToken = 0;
+        this->carriedPosition = 0;
+        this->spill.clear();
+        this->stopped = false;
+    }
+
+
+
+private:
+
+    // Determines if the scan stopped part way through a token, which then has to be carried over.
+    bool _intoken() const
+    {
+        return this->scan.state != compiled_tokenizer<T>::STATE_START && this->scan.state != compiled_tokenizer<T>::STATE_IGNORE;
+    }
+
+    // Adds a token found by the tokenizer in the specified buffer, and starts looking for the next one.
+    void _addtoken(T *buffer, const T *tokenStart, const T *tokenEnd, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines)
+    {
+        reference_string<T> token;
+        token.start = buffer + (tokenStart - buffer);
+        token.end   = buffer + (tokenEnd - buffer);
+        tokens.push_back(token);
+
+        if (lines != NULL)
+        {
+            lines->push_back(this->scan.lineCount);
+        }
+
+        this->scan = compiled_tokenizer<T>::_newscan();
+    }
+
+    // Carries over the rest of a buffer where the scan stopped at 'str', along with the token so far.
+    void _carry(const T *tokenStart, const T *str, const T *end)
+    {
+        const T *start = this->_intoken() ? tokenStart : str;
+
+        this->carried.assign(start, end);
+        this->carriedToken    = 0;
+        this->carriedPosition = (size_t)(str - start);
+    }
+
+    // Tokenises the text in the spill buffer, appending as much of the chunk to it as is needed to
+    // get past it. Returns false if the whole chunk ended up being carried over. Otherwise
+    // 'chunkPosition' is set to where tokenising continues in the chunk.
+    bool _feedspill(T *chunk, size_t chunkLength, size_t &chunkPosition, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines)
+    {
+        size_t boundary = this->spill.size();
+        size_t appended = 0;
+        size_t position = this->carriedPosition;
+        size_t token_position = this->carriedToken;
+
+        // The spill buffer grows while it's being tokenised, so the tokens in it are recorded as
+        // offsets until it's done.
+        size_t first_token = tokens.size();
+        std::vector<size_t> starts;
+        std::vector<size_t> ends;
+
+        bool carry = false;
+        for (;;)
+        {
+            // Bring in more of the chunk, doubling the amount each time so a long token is only
+            // copied a few times.
+            if (appended == chunkLength)
+            {
+                // Even the whole chunk wasn't enough.
+                carry = true;
+                break;
+            }
+
+            size_t amount = (this->spill.size() > 64) ? this->spill.size() : 64;
+            if (amount > chunkLength - appended)
+            {
+                amount = chunkLength - appended;
+            }
+
+            this->spill.insert(this->spill.end(), chunk + appended, chunk + appended + amount);
+            appended += amount;
+
+
+            T *spill_str = &this->spill[0];
+            const T *str  = spill_str + position;
+            const T *end  = spill_str + this->spill.size();
+            const T *stop = (this->spill.size() > this->lookaheadLength) ? end - this->lookaheadLength : spill_str;
+            const T *token_start = spill_str + token_position;
+            const T *token_end;
+
+            int result;
+            while ((result = this->tokenizer._scan(str, end, stop, token_start, token_end, this->scan)) == 1)
+            {
+                starts.push_back((size_t)(token_start - spill_str));
+                ends.push_back((size_t)(token_end - spill_str));
+                this->_addtoken(spill_str, token_start, token_end, tokens, lines);
+
+                if ((size_t)(str - spill_str) >= boundary)
+                {
+                    break;
+                }
+            }
+
+            position       = (size_t)(str - spill_str);
+            token_position = (size_t)(token_start - spill_str);
+
+            if (result == 0)
+            {
+                this->stopped = true;
+                carry = true;
+                break;
+            }
+
+            // Once the scan is into the chunk and not inside a token, it can carry on in the chunk.
+            if (position >= boundary && !this->_intoken())
+            {
+                break;
+            }
+        }
+
+        // Tokens that don't include any of the carried text are pointed at the chunk instead.
+        T *spill_str = &this->spill[0];
+        for (size_t i = 0; i < starts.size(); ++i)
+        {
+            reference_string<T> &token = tokens[first_token + i];
+            if (starts[i] >= boundary)
+            {
+                token.start = chunk + (starts[i] - boundary);
+                token.end   = chunk + (ends[i]   - boundary);
+            }
+            else
+            {
+                token.start = spill_str + starts[i];
+                token.end   = spill_str + ends[i];
+            }
+        }
+
+        if (carry)
+        {
+            if (this->stopped)
+            {
+                return false;
+            }
+
+            if (this->_intoken())
+            {
+                // Rather than copying a token that could be long, the whole buffer is carried
+                // over. Swapping leaves the tokens already found in it where they are.
+                this->carried.swap(this->spill);
+                this->carriedToken    = token_position;
+                this->carriedPosition = position;
+            }
+            else
+            {
+                this->_carry(spill_str + token_position, spill_str + position, spill_str + this->spill.size());
+            }
+
+            return false;
+        }
+
+        chunkPosition = position - boundary;
+        return true;
+    }
+
+
+    /// The tokenizer.
+    compiled_tokenizer<T> tokenizer;
+
+    /// The value of tokenizer.lookahead().
+    size_t lookaheadLength;
+
+    /// Where the scan stopped at the end of the last chunk.
+    typename compiled_tokenizer<T>::_scan_state scan;
+
+    /// The text the scan hadn't got past at the end of the last chunk, waiting for the next one,
+    /// along with the token the scan was part way through, if there was one.
+    std::vector<T> carried;
+
+    /// The offsets in 'carried' of the token the scan was part way through, and of where the scan carries on.
+    size_t carriedToken;
+    size_t carriedPosition;
+
+    /// The buffer holding tokens that straddled a chunk boundary.
+    std::vector<T> spill;
+
+    /// Whether or not the tokenizer has stopped for good, such as at an invalid character.
+    bool stopped;
+};
+
+}
+
+#endif // DRSL_TOKENS_TOKEN_STREAM
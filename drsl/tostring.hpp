@@ -6,135 +6,124 @@
 namespace drsl
 {
 
-#ifdef DRSL_ONLY_ASCII
-inline void tostring(__int64 value, char *dest, size_t destSize)
-{
-    drsl::format(dest, destSize, "%I64d", value);
-}
-inline void tostring(unsigned __int64 value, char *dest, size_t destSize)
-{
-    drsl::format(dest, destSize, "%I64u", value);
-}
-inline void tostring(int value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
-}
-inline void tostring(unsigned int value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
-}
-inline void tostring(long value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
-}
-inline void tostring(unsigned long value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
-}
-inline void tostring(short value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
-}
-inline void tostring(unsigned short value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
-}
-inline void tostring(char value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
-}
-inline void tostring(unsigned char value, char *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
-}
-inline void tostring(float value, char *dest, size_t destSize)
-{
-    drsl::format(dest, destSize, "%f", value);
-}
-inline void tostring(double value, char *dest, size_t destSize)
+/**
+*   \brief                 Converts an integer to a string.
+*   \param  value    [in]  The value to convert.
+*   \param  dest     [out] Pointer to the buffer that will recieve the string.
+*   \param  destSize [in]  The number of T's that can fit inside \c dest including the null terminator.
+*   \return                The number of T's required to store the string, including the null terminator.
+*
+*   \remarks
+*       The value is written in base 10 straight into the destination. See inttostring() for other
+*       bases and zero padding.
+*       \par
+*       If \c dest is NULL, nothing is written and the required size is returned.
+*/
+template <typename T>
+inline size_t tostring(long long value, T *dest, size_t destSize)
 {
-    drsl::format(dest, destSize, "%.12g", value);
+    return drsl::inttostring(value, dest, destSize);
 }
-inline void tostring(bool value, char *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(unsigned long long value, T *dest, size_t destSize)
 {
-    // We'll have to do locale dependant strings here.
-    if (value)
-    {
-        drsl::copy(dest, "true", destSize, 4);
-    }
-    else
-    {
-        drsl::copy(dest, "false", destSize, 5);
-    }
+    return drsl::inttostring(value, dest, destSize);
 }
-#endif
 
-
-inline void tostring(__int64 value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(int value, T *dest, size_t destSize)
 {
-    drsl::format(dest, destSize, L"%I64d", value);
+    return drsl::inttostring(value, dest, destSize);
 }
-inline void tostring(unsigned __int64 value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(unsigned int value, T *dest, size_t destSize)
 {
-    drsl::format(dest, destSize, L"%I64u", value);
+    return drsl::inttostring(value, dest, destSize);
 }
 
-inline void tostring(int value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(long value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
+    return drsl::inttostring(value, dest, destSize);
 }
-inline void tostring(unsigned int value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(unsigned long value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    return drsl::inttostring(value, dest, destSize);
 }
 
-inline void tostring(long value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(short value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
+    return drsl::inttostring(value, dest, destSize);
 }
-inline void tostring(unsigned long value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(unsigned short value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    return drsl::inttostring(value, dest, destSize);
 }
 
-inline void tostring(short value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(char value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
+    return drsl::inttostring(static_cast<signed char>(value), dest, destSize);
 }
-inline void tostring(unsigned short value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(signed char value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    return drsl::inttostring(value, dest, destSize);
 }
-
-inline void tostring(char value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(unsigned char value, T *dest, size_t destSize)
 {
-    drsl::tostring(static_cast<__int64>(value), dest, destSize);
-}
-inline void tostring(unsigned char value, wchar_t *dest, size_t destSize)
-{
-    drsl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    return drsl::inttostring(value, dest, destSize);
 }
 
-inline void tostring(float value, wchar_t *dest, size_t destSize)
+/**
+*   \brief                 Converts a floating point value to a string.
+*   \param  value    [in]  The value to convert.
+*   \param  dest     [out] Pointer to the buffer that will recieve the string.
+*   \param  destSize [in]  The number of T's that can fit inside \c dest including the null terminator.
+*   \return                The number of T's required to store the string, including the null terminator.
+*
+*   \remarks
+*       The value is written with the fewest digits that still convert back to exactly the
+*       same value. See floattostring() for control over the notation.
+*/
+template <typename T>
+inline size_t tostring(float value, T *dest, size_t destSize)
 {
-    drsl::format(dest, destSize, L"%f", value);
+    return drsl::floattostring(value, dest, destSize);
 }
-inline void tostring(double value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(double value, T *dest, size_t destSize)
 {
-    drsl::format(dest, destSize, L"%.12g", value);
+    return drsl::floattostring(value, dest, destSize);
 }
 
-inline void tostring(bool value, wchar_t *dest, size_t destSize)
+template <typename T>
+inline size_t tostring(bool value, T *dest, size_t destSize)
 {
     // TODO: Need to check the locale and do locale dependant values.
-    if (value)
+    const char *name = value ? "true" : "false";
+    size_t name_size = value ? 5 : 6;
+
+    if (dest == NULL || destSize < name_size)
     {
-        drsl::copy(dest, L"true", destSize, 4);
+        if (dest != NULL && destSize > 0)
+        {
+            dest[0] = '\0';
+        }
+
+        return name_size;
     }
-    else
+
+    for (size_t i = 0; i < name_size; ++i)
     {
-        drsl::copy(dest, L"false", destSize, 5);
+        dest[i] = (T)name[i];
     }
+
+    return name_size;
 }
 
 /**
@@ -167,7 +156,7 @@ inline void tostring(U value, T *dest, size_t destSize)
 template <size_t destSize, typename U, typename T>
 inline void tostring(U value, T (&dest)[destSize])
 {
-    return tostring(value, (T *)dest, destSize);
+    tostring(value, (T *)dest, destSize);
 }
 
 }
@@ -0,0 +1,625 @@
+// Copyright (C) 2016 David Reid. See included LICENSE file.
+
+#ifndef DRSL_TRYPARSE
+#define DRSL_TRYPARSE
+
+namespace drsl
+{
+
+/**
+*   \brief  Retrieves the code unit at \c index, or 0 if the index is past the end of the string.
+*/
+template <typename T>
+inline char32_t _unitat(const T *str, size_t strLength, size_t index)
+{
+    return (index < strLength) ? _codeunit(str[index]) : 0;
+}
+
+template <typename T>
+inline bool _isdigitat(const T *str, size_t strLength, size_t index)
+{
+    return (char32_t)(_unitat(str, strLength, index) - '0') <= 9;
+}
+
+
+/**
+*   \brief                   Validates and converts an integer at the start of a string.
+*   \param  str        [in]  The string to parse.
+*   \param  strLength  [in]  The length in T's of the string.
+*   \param  isSigned   [in]  Whether or not a leading '-' is allowed.
+*   \param  maxValue   [in]  The largest positive value of the target type.
+*   \param  magnitude  [out] Receives the absolute value of the integer.
+*   \param  negative   [out] Receives whether or not the integer is negative.
+*   \param  consumed   [out] Receives the number of T's making up the integer, including any suffix.
+*   \return                  True if an integer was found and it fits in the target type; false otherwise.
+*
+*   \remarks
+*       Signed integers can have the suffixes "l" and "ll". Unsigned integers can also be
+*       suffixed with "u", on its own or combined with "l" or "ll" in either order.
+*/
+template <typename T>
+inline bool _tryparse_integer(const T *str, size_t strLength, bool isSigned, uint64_t maxValue, uint64_t *magnitude, bool *negative, size_t *consumed)
+{
+    size_t i = 0;
+
+    *negative = false;
+    if (isSigned && _unitat(str, strLength, 0) == '-')
+    {
+        *negative = true;
+        i += 1;
+    }
+
+    // Negative values can go one further than positive ones.
+    uint64_t limit = maxValue + (*negative ? 1 : 0);
+
+    size_t digits_start = i;
+    uint64_t value = 0;
+    bool overflow = false;
+
+    // When the length is known, runs of 8 digits can be converted together.
+    if (strLength != (size_t)-1)
+    {
+        uint64_t eight_digits;
+        while (strLength - i >= 8 && _readeightdigits(str + i, &eight_digits) && eight_digits <= limit && value <= (limit - eight_digits) / 100000000)
+        {
+            value = value * 100000000 + eight_digits;
+            i += 8;
+        }
+    }
+
+    char32_t digit;
+    while ((digit = _unitat(str, strLength, i) - '0') <= 9)
+    {
+        if (value > (limit - digit) / 10)
+        {
+            overflow = true;
+        }
+
+        value = value * 10 + digit;
+        i += 1;
+    }
+
+    if (i == digits_start || overflow)
+    {
+        return false;
+    }
+
+
+    // Suffixes.
+    bool found_u = false;
+
+    char32_t ch = _unitat(str, strLength, i);
+    if (!isSigned && (ch == 'u' || ch == 'U'))
+    {
+        found_u = true;
+        i += 1;
+        ch = _unitat(str, strLength, i);
+    }
+
+    if (ch == 'l' || ch == 'L')
+    {
+        i += 1;
+
+        // "ll" and "LL" are fine, but "lL" is not.
+        if (_unitat(str, strLength, i) == ch)
+        {
+            i += 1;
+        }
+
+        ch = _unitat(str, strLength, i);
+        if (!isSigned && !found_u && (ch == 'u' || ch == 'U'))
+        {
+            i += 1;
+        }
+    }
+
+    *magnitude = value;
+    *consumed  = i;
+    return true;
+}
+
+
+/**
+*   \brief                      Validates and converts a floating point value at the start of a string.
+*   \param  str          [in]   The string to parse.
+*   \param  strLength    [in]   The length in T's of the string.
+*   \param  singleFloat  [in]   Whether the target type is float rather than double. This controls the suffixes and rounding.
+*   \param  allowInteger [in]   Whether or not a plain integer with no decimal point, exponent or suffix is accepted.
+*   \param  bits         [out]  Receives the bits of the converted value as either a float or double.
+*   \param  consumed     [out]  Receives the number of T's making up the value, including any suffix.
+*   \return                     True if a value was found and it is within range of the target type; false otherwise.
+*
+*   \remarks
+*       The value must have at least one digit and either a decimal point, an exponent or a suffix
+*       in order to be considered a floating point value. A decimal point must be followed by a
+*       digit. Floats can have an "f" suffix and doubles can have a "d" or "l" suffix.
+*       \par
+*       The conversion is correctly rounded and does not depend on the locale. The common case
+*       of 19 or fewer significant digits and a small exponent is done with a single floating
+*       point operation. Everything else falls back to an exact decimal conversion.
+*/
+template <typename T>
+inline bool _tryparse_float(const T *str, size_t strLength, bool singleFloat, bool allowInteger, uint64_t *bits, size_t *consumed)
+{
+    static const double double_powers_of_10[23] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    static const float float_powers_of_10[11] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+
+    size_t i = 0;
+
+    bool negative = false;
+    if (_unitat(str, strLength, 0) == '-')
+    {
+        negative = true;
+        i += 1;
+    }
+
+    // The first 19 significant digits are accumulated into an integer, which is enough to decide
+    // whether or not the fast path can be used.
+    size_t digits_start = i;
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool truncated = false;
+    bool found_digit = false;
+    bool found_decimal = false;
+
+    for (;;)
+    {
+        // When the length is known, runs of 8 digits can be converted together.
+        uint64_t eight_digits;
+        if (strLength != (size_t)-1 && strLength - i >= 8 && significant_digits <= 11 && _readeightdigits(str + i, &eight_digits))
+        {
+            found_digit = true;
+
+            mantissa = mantissa * 100000000 + eight_digits;
+            significant_digits = (mantissa != 0) ? (int)_decimallength(mantissa) : 0;
+
+            if (found_decimal)
+            {
+                exponent -= 8;
+            }
+
+            i += 8;
+            continue;
+        }
+
+        char32_t digit = _unitat(str, strLength, i) - '0';
+        if (digit <= 9)
+        {
+            found_digit = true;
+
+            if (significant_digits < 19)
+            {
+                mantissa = mantissa * 10 + digit;
+                if (mantissa != 0)
+                {
+                    significant_digits += 1;
+                }
+
+                if (found_decimal)
+                {
+                    exponent -= 1;
+                }
+            }
+            else
+            {
+                if (!found_decimal)
+                {
+                    exponent += 1;
+                }
+
+                if (digit != 0)
+                {
+                    truncated = true;
+                }
+            }
+        }
+        else if (digit == (char32_t)('.' - '0') && !found_decimal && _isdigitat(str, strLength, i + 1))
+        {
+            found_decimal = true;
+        }
+        else
+        {
+            break;
+        }
+
+        i += 1;
+    }
+
+    if (!found_digit)
+    {
+        return false;
+    }
+
+    size_t digits_end = i;
+
+
+    // Exponent. The 'e' is only part of the number if it's followed by digits.
+    int explicit_exponent = 0;
+    bool found_exponent = false;
+
+    char32_t ch = _unitat(str, strLength, i);
+    if (ch == 'e' || ch == 'E')
+    {
+        size_t j = i + 1;
+
+        bool negative_exponent = false;
+        ch = _unitat(str, strLength, j);
+        if (ch == '-' || ch == '+')
+        {
+            negative_exponent = (ch == '-');
+            j += 1;
+        }
+
+        if (_isdigitat(str, strLength, j))
+        {
+            found_exponent = true;
+
+            char32_t digit;
+            while ((digit = _unitat(str, strLength, j) - '0') <= 9)
+            {
+                // Anything this big is going to be zero or infinity anyway.
+                if (explicit_exponent < 100000)
+                {
+                    explicit_exponent = explicit_exponent * 10 + (int)digit;
+                }
+
+                j += 1;
+            }
+
+            if (negative_exponent)
+            {
+                explicit_exponent = -explicit_exponent;
+            }
+
+            i = j;
+        }
+    }
+
+    // Suffix.
+    bool found_suffix = false;
+
+    ch = _unitat(str, strLength, i);
+    if (singleFloat ? (ch == 'f' || ch == 'F') : (ch == 'd' || ch == 'D' || ch == 'l' || ch == 'L'))
+    {
+        found_suffix = true;
+        i += 1;
+    }
+
+    // Without any of these it's an integer.
+    if (!found_decimal && !found_exponent && !found_suffix && !allowInteger)
+    {
+        return false;
+    }
+
+
+    exponent += explicit_exponent;
+
+    uint64_t sign_bit = (uint64_t)(negative ? 1 : 0) << (singleFloat ? 31 : 63);
+
+    // Fast path. When the mantissa and the power of 10 are both exactly representable, a single
+    // multiplication or division gives a correctly rounded result.
+    if (!truncated)
+    {
+        if (singleFloat)
+        {
+            if (mantissa <= (1ULL << 24) && exponent >= -10 && exponent <= 10)
+            {
+                float result = (float)mantissa;
+                if (exponent < 0)
+                {
+                    result /= float_powers_of_10[-exponent];
+                }
+                else
+                {
+                    result *= float_powers_of_10[exponent];
+                }
+
+                uint32_t result_bits;
+                memcpy(&result_bits, &result, sizeof(result_bits));
+
+                *bits = result_bits | sign_bit;
+                *consumed = i;
+                return true;
+            }
+        }
+        else
+        {
+            if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+            {
+                double result = (double)mantissa;
+                if (exponent < 0)
+                {
+                    result /= double_powers_of_10[-exponent];
+                }
+                else
+                {
+                    result *= double_powers_of_10[exponent];
+                }
+
+                memcpy(bits, &result, sizeof(*bits));
+
+                *bits |= sign_bit;
+                *consumed = i;
+                return true;
+            }
+        }
+    }
+
+
+    // Slow path. Run over the digits again, this time keeping all of them.
+    _decimal decimal;
+    _decimal_init(decimal);
+
+    bool found_point = false;
+    for (size_t j = digits_start; j < digits_end; ++j)
+    {
+        char32_t c = _codeunit(str[j]);
+        if (c == '.')
+        {
+            found_point = true;
+            decimal.point = decimal.count;
+        }
+        else
+        {
+            if (c == '0' && decimal.count == 0)
+            {
+                // Leading zeros only move the decimal point.
+                decimal.point -= 1;
+                continue;
+            }
+
+            _decimal_pushdigit(decimal, c - '0');
+        }
+    }
+
+    if (!found_point)
+    {
+        decimal.point = decimal.count;
+    }
+
+    decimal.point += explicit_exponent;
+
+    bool overflow;
+    uint64_t result_bits = singleFloat ? _decimal_tofloatbits(decimal, 23, 8, &overflow) : _decimal_tofloatbits(decimal, 52, 11, &overflow);
+    if (overflow)
+    {
+        return false;
+    }
+
+    *bits = result_bits | sign_bit;
+    *consumed = i;
+    return true;
+}
+
+
+template <typename T>
+inline bool _tryparse_bool(const T *str, size_t strLength, bool *value, size_t *consumed)
+{
+    static const char *names[4] = {"false", "0", "true", "1"};
+
+    for (int iName = 0; iName < 4; ++iName)
+    {
+        const char *name = names[iName];
+
+        size_t i = 0;
+        while (name[i] != '\0')
+        {
+            char32_t ch = _unitat(str, strLength, i);
+            if (ch >= 'A' && ch <= 'Z')
+            {
+                ch += 'a' - 'A';
+            }
+
+            if (ch != (char32_t)name[i])
+            {
+                break;
+            }
+
+            i += 1;
+        }
+
+        if (name[i] == '\0')
+        {
+            *value = (iName >= 2);
+            *consumed = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// NOTE: Like _istype, this structure is used because we don't have partial specialisation for functions.
+template <typename U, typename T>
+struct _tryparse
+{
+    static bool call(const T *str, size_t strLength, U *value, size_t *consumed)
+    {
+        (void)str;
+        (void)strLength;
+        (void)value;
+        (void)consumed;
+
+        // If we make it here, the type can not be converted.
+        assert(false);
+        return false;
+    }
+};
+
+template <typename U, typename T>
+struct _tryparse_signed
+{
+    static inline bool call(const T *str, size_t strLength, U *value, size_t *consumed)
+    {
+        uint64_t magnitude;
+        bool negative;
+        if (!_tryparse_integer(str, strLength, true, (1ULL << (sizeof(U) * 8 - 1)) - 1, &magnitude, &negative, consumed))
+        {
+            return false;
+        }
+
+        if (negative)
+        {
+            // Done in two steps so that the most negative value doesn't overflow.
+            *value = (U)(-(long long)(magnitude - 1) - 1);
+        }
+        else
+        {
+            *value = (U)magnitude;
+        }
+
+        return true;
+    }
+};
+
+template <typename U, typename T>
+struct _tryparse_unsigned
+{
+    static inline bool call(const T *str, size_t strLength, U *value, size_t *consumed)
+    {
+        uint64_t magnitude;
+        bool negative;
+        if (!_tryparse_integer(str, strLength, false, ~0ULL >> (64 - sizeof(U) * 8), &magnitude, &negative, consumed))
+        {
+            return false;
+        }
+
+        *value = (U)magnitude;
+        return true;
+    }
+};
+
+template <typename T> struct _tryparse<long long, T>          : _tryparse_signed<long long, T> {};
+template <typename T> struct _tryparse<unsigned long long, T> : _tryparse_unsigned<unsigned long long, T> {};
+template <typename T> struct _tryparse<long, T>               : _tryparse_signed<long, T> {};
+template <typename T> struct _tryparse<unsigned long, T>      : _tryparse_unsigned<unsigned long, T> {};
+template <typename T> struct _tryparse<int, T>                : _tryparse_signed<int, T> {};
+template <typename T> struct _tryparse<unsigned int, T>       : _tryparse_unsigned<unsigned int, T> {};
+template <typename T> struct _tryparse<short, T>              : _tryparse_signed<short, T> {};
+template <typename T> struct _tryparse<unsigned short, T>     : _tryparse_unsigned<unsigned short, T> {};
+template <typename T> struct _tryparse<char, T>               : _tryparse_signed<char, T> {};
+template <typename T> struct _tryparse<signed char, T>        : _tryparse_signed<signed char, T> {};
+template <typename T> struct _tryparse<unsigned char, T>      : _tryparse_unsigned<unsigned char, T> {};
+
+template <typename T>
+struct _tryparse<double, T>
+{
+    static inline bool call(const T *str, size_t strLength, double *value, size_t *consumed)
+    {
+        uint64_t bits;
+        if (!_tryparse_float(str, strLength, false, false, &bits, consumed))
+        {
+            return false;
+        }
+
+        memcpy(value, &bits, sizeof(*value));
+        return true;
+    }
+};
+
+template <typename T>
+struct _tryparse<float, T>
+{
+    static inline bool call(const T *str, size_t strLength, float *value, size_t *consumed)
+    {
+        uint64_t bits;
+        if (!_tryparse_float(str, strLength, true, false, &bits, consumed))
+        {
+            return false;
+        }
+
+        uint32_t bits32 = (uint32_t)bits;
+        memcpy(value, &bits32, sizeof(*value));
+        return true;
+    }
+};
+
+template <typename T>
+struct _tryparse<bool, T>
+{
+    static inline bool call(const T *str, size_t strLength, bool *value, size_t *consumed)
+    {
+        return _tryparse_bool(str, strLength, value, consumed);
+    }
+};
+
+
+/**
+*   \brief                   Validates a string as a value of a particular data type and converts it in a single pass.
+*   \param  str        [in]  The string to parse.
+*   \param  strLength  [in]  The length in T's of the string.
+*   \param  value      [out] Receives the converted value. Can be NULL.
+*   \param  consumed   [out] Receives the number of T's that make up the value. Can be NULL.
+*   \return                  True if the string is a valid value of type U; false otherwise.
+*
+*   \remarks
+*       The grammar is the one used by istype(): integers are an optional '-' (signed types only)
+*       followed by digits, floating point values must also contain a decimal point, an exponent
+*       or a suffix, and the standard C suffixes for the type are allowed ("u", "l" and "ll" for
+*       integers, "f" for floats and "d" or "l" for doubles). Booleans are "true", "false", "1"
+*       or "0", case insensitive.
+*       \par
+*       When \c consumed is NULL, the entire string must be the value. Otherwise the value only
+*       needs to be at the start of the string, \c consumed is set to the number of T's that
+*       were used, and the rest of the string is left for the caller.
+*       \par
+*       Values that are out of range of U are rejected rather than clamped or wrapped. Floating
+*       point values that are too small to be represented become zero.
+*       \par
+*       Nothing is allocated, no locale is consulted and \c value is only written to if the
+*       function succeeds.
+*/
+template <typename U, typename T>
+inline bool tryparse(const T *str, size_t strLength, U *value, size_t *consumed = NULL)
+{
+    if (consumed != NULL)
+    {
+        *consumed = 0;
+    }
+
+    if (str == NULL)
+    {
+        return false;
+    }
+
+    U result;
+    size_t result_length;
+    if (!_tryparse<U, T>::call(str, strLength, &result, &result_length))
+    {
+        return false;
+    }
+
+    if (consumed != NULL)
+    {
+        *consumed = result_length;
+    }
+    else if (result_length < strLength && str[result_length] != '\0')
+    {
+        return false;
+    }
+
+    if (value != NULL)
+    {
+        *value = result;
+    }
+
+    return true;
+}
+
+template <typename U, typename T>
+inline bool tryparse(const reference_string<T> &str, U *value, size_t *consumed = NULL)
+{
+    return tryparse(str.start, length(str), value, consumed);
+}
+
+
+}
+
+#endif // DRSL_TRYPARSE
@@ -123,13 +123,23 @@ inline size_t writechar(char32_t *&dest, char32_t character)
 // \copydoc writechar(char *, char32_t)
 inline size_t writechar(wchar_t *&dest, char32_t character)
 {
-    switch (sizeof(wchar_t))
+    // The pointer is moved through a copy of the right type. Casting the reference itself would
+    // break strict aliasing, and the move could be lost when optimizing.
+    size_t count;
+    if (sizeof(wchar_t) == 2)
     {
-    case 2: return writechar((char16_t *&)dest, character);
-    case 4: return writechar((char16_t *&)dest, character);
+        char16_t *temp = (char16_t *)dest;
+        count = writechar(temp, character);
+        dest = (wchar_t *)temp;
+    }
+    else
+    {
+        char32_t *temp = (char32_t *)dest;
+        count = writechar(temp, character);
+        dest = (wchar_t *)temp;
     }
 
-    return writechar((char32_t *&)dest, character);
+    return count;
 }
 
 